@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "array-deque.hpp"
+#include "throw-errno.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <sys/uio.h>
+
+namespace utility::detail::array_deque_io {
+    namespace std = ::std;
+
+    using ::utility::ArrayDeque;
+    using ::utility::span;
+    using ::utility::throw_errno;
+
+    /**
+     * Written before the elements by write_to().
+     */
+    struct Header {
+        std::uint64_t m_magic;
+        std::uint64_t m_item_size;
+        std::uint64_t m_size;
+    };
+
+    // "cxxdqio1" when read as little-endian bytes.
+    inline constexpr std::uint64_t magic = 0x316f697164787863;
+
+    template <typename T>
+    ::iovec make_iovec(span<T> items) noexcept {
+        return {
+            const_cast<void*>(static_cast<const void*>(items.data())),
+            items.size_bytes(),
+        };
+    }
+
+    /**
+     * Calls readv() or writev() (`func`) until all of the buffers have
+     * been transferred. The iovecs are modified. Returns false if the end
+     * of the file was reached first.
+     */
+    template <typename Func>
+    bool transfer_all(Func func, ::iovec* iov, int count, const char* what) {
+        while (true) {
+            for (; count > 0 && iov->iov_len == 0; ++iov, --count) {
+            }
+            if (count == 0) {
+                return true;
+            }
+            ::ssize_t n = func(iov, count);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw_errno(what);
+            }
+            if (n == 0) {
+                return false;
+            }
+            auto done = static_cast<std::size_t>(n);
+            for (; count > 0 && done >= iov->iov_len; ++iov, --count) {
+                done -= iov->iov_len;
+            }
+            if (count > 0) {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + done;
+                iov->iov_len -= done;
+            }
+        }
+    }
+
+    /**
+     * Gets iovecs that describe the elements of `deque`, in order. The
+     * second one is empty unless the elements wrap around the end of the
+     * buffer.
+     */
+    template <typename T, typename Allocator, std::size_t N, typename Policy>
+    std::array<::iovec, 2> as_iovecs(
+        const ArrayDeque<T, Allocator, N, Policy>& deque
+    ) noexcept {
+        auto [first, second] = deque.as_spans();
+        return {make_iovec(first), make_iovec(second)};
+    }
+
+    /**
+     * Gets iovecs that describe the unoccupied slots after the last
+     * element of `deque` (see ArrayDeque::free_spans()). Data read into
+     * them can be added with ArrayDeque::commit_back().
+     */
+    template <typename T, typename Allocator, std::size_t N, typename Policy>
+    std::array<::iovec, 2> free_iovecs(
+        ArrayDeque<T, Allocator, N, Policy>& deque
+    ) noexcept {
+        auto [first, second] = deque.free_spans();
+        return {make_iovec(first), make_iovec(second)};
+    }
+
+    /**
+     * Writes the elements of `deque`, preceded by a small header, to the
+     * file descriptor `fd` with a single writev() call (unless it writes
+     * only part of the data). The elements must be trivially copyable.
+     */
+    template <typename T, typename Allocator, std::size_t N, typename Policy>
+    void write_to(int fd, const ArrayDeque<T, Allocator, N, Policy>& deque) {
+        static_assert(
+            std::is_trivially_copyable_v<T>,
+            "elements must be trivially copyable"
+        );
+        Header header = {magic, sizeof(T), deque.size()};
+        auto [first, second] = as_iovecs(deque);
+        ::iovec iov[3] = {{&header, sizeof(header)}, first, second};
+        auto func = [fd](const ::iovec* iov, int count) {
+            return ::writev(fd, iov, count);
+        };
+        transfer_all(func, iov, 3, "write_to(): writev");
+    }
+
+    /**
+     * Replaces the elements of `deque` with elements written by
+     * write_to(), read from the file descriptor `fd`. The elements are
+     * read directly into the buffer, which is resized at most once (to
+     * the capacity the deque's policy uses for the number of elements).
+     */
+    template <typename T, typename Allocator, std::size_t N, typename Policy>
+    void read_from(int fd, ArrayDeque<T, Allocator, N, Policy>& deque) {
+        static_assert(
+            std::is_trivially_copyable_v<T>,
+            "elements must be trivially copyable"
+        );
+        auto func = [fd](const ::iovec* iov, int count) {
+            return ::readv(fd, iov, count);
+        };
+        Header header;
+        ::iovec header_iov = {&header, sizeof(header)};
+        if (!transfer_all(func, &header_iov, 1, "read_from(): readv")) {
+            throw std::runtime_error("read_from(): unexpected end of file");
+        }
+        bool valid = (
+            header.m_magic == magic &&
+            header.m_item_size == sizeof(T) &&
+            header.m_size <= deque.max_size()
+        );
+        if (!valid) {
+            throw std::runtime_error("read_from(): invalid header");
+        }
+        auto size = static_cast<std::size_t>(header.m_size);
+        deque.clear_keep_capacity();
+        deque.reserve(size);
+        auto [first, second] = deque.free_spans();
+        std::size_t first_size = std::min(size, first.size());
+        ::iovec iov[2] = {
+            make_iovec(first.first(first_size)),
+            make_iovec(second.first(size - first_size)),
+        };
+        if (!transfer_all(func, iov, 2, "read_from(): readv")) {
+            throw std::runtime_error("read_from(): unexpected end of file");
+        }
+        deque.commit_back(size);
+    }
+}
+
+namespace utility {
+    /**
+     * Scatter/gather I/O for ArrayDeques of trivially copyable elements.
+     * write_to(fd, deque) writes a header and the elements' one or two
+     * contiguous segments with writev(); read_from(fd, deque) reads them
+     * back directly into the deque's buffer with readv(). as_iovecs() and
+     * free_iovecs() describe the occupied and free parts of the buffer for
+     * use with other vectored I/O calls.
+     */
+    using detail::array_deque_io::as_iovecs;
+    using detail::array_deque_io::free_iovecs;
+    using detail::array_deque_io::write_to;
+    using detail::array_deque_io::read_from;
+}
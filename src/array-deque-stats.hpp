@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+
+// Define to 1 to collect ArrayDeque allocation and resizing statistics.
+// Must have the same value in every translation unit of a program.
+#ifndef CXXUTIL_ARRAY_DEQUE_STATS
+    #define CXXUTIL_ARRAY_DEQUE_STATS 0
+#endif
+
+#if CXXUTIL_ARRAY_DEQUE_STATS
+    #include <atomic>
+    #include <mutex>
+#endif
+
+namespace utility::detail::array_deque_stats {
+    namespace std = ::std;
+
+    struct ArrayDequeStats {
+        // Buffer growths caused by inserting into a full deque.
+        std::size_t grows = 0;
+        // All changes of the buffer size, including grows, reserve(), and
+        // shrinking.
+        std::size_t resizes = 0;
+        // Bytes of elements moved or copied by resizes.
+        std::size_t bytes_moved = 0;
+        // Capacity of the largest allocated buffer, in elements.
+        std::size_t peak_capacity = 0;
+        std::size_t allocations = 0;
+        std::size_t bytes_allocated = 0;
+
+        /**
+         * Adds the counts in `other` to these ones.
+         */
+        void merge(const ArrayDequeStats& other) noexcept {
+            grows += other.grows;
+            resizes += other.resizes;
+            bytes_moved += other.bytes_moved;
+            peak_capacity = std::max(peak_capacity, other.peak_capacity);
+            allocations += other.allocations;
+            bytes_allocated += other.bytes_allocated;
+        }
+    };
+
+    /**
+     * Passed to the resize hook after an ArrayDeque's buffer is resized.
+     */
+    struct ResizeEvent {
+        const void* deque;
+        std::size_t item_size;
+        std::size_t size;
+        std::size_t old_capacity;
+        std::size_t new_capacity;
+        std::size_t bytes_moved;
+    };
+
+    using ResizeHook = void (*)(const ResizeEvent&);
+
+    #if CXXUTIL_ARRAY_DEQUE_STATS
+        class ThreadStats;
+
+        /**
+         * Tracks the per-thread counters of live threads, in an intrusive
+         * list so that registering a thread never allocates, and the
+         * merged counters of threads that have exited.
+         */
+        struct Registry {
+            std::mutex m_mutex;
+            ThreadStats* m_threads = nullptr;
+            ArrayDequeStats m_exited;
+            std::atomic<ResizeHook> m_hook {nullptr};
+        };
+
+        inline Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        /**
+         * Counters for the deques used by one thread. Only the owning
+         * thread writes them, so updates are plain relaxed loads and
+         * stores; other threads may read them at any time.
+         */
+        class ThreadStats {
+            public:
+            /**
+             * Links these counters into the registry. This is constructed
+             * on a thread's first record() call, which is noexcept, so it
+             * must not throw.
+             */
+            ThreadStats() noexcept {
+                Registry& reg = registry();
+                std::lock_guard lock(reg.m_mutex);
+                m_next = reg.m_threads;
+                if (m_next) {
+                    m_next->m_prev = this;
+                }
+                reg.m_threads = this;
+            }
+
+            ThreadStats(const ThreadStats&) = delete;
+            ThreadStats& operator=(const ThreadStats&) = delete;
+
+            ~ThreadStats() {
+                Registry& reg = registry();
+                std::lock_guard lock(reg.m_mutex);
+                reg.m_exited.merge(load());
+                if (m_prev) {
+                    m_prev->m_next = m_next;
+                } else {
+                    reg.m_threads = m_next;
+                }
+                if (m_next) {
+                    m_next->m_prev = m_prev;
+                }
+            }
+
+            /**
+             * Gets the next thread's counters in the registry's list.
+             */
+            const ThreadStats* next() const noexcept {
+                return m_next;
+            }
+
+            void add(const ArrayDequeStats& stats) noexcept {
+                add(m_grows, stats.grows);
+                add(m_resizes, stats.resizes);
+                add(m_bytes_moved, stats.bytes_moved);
+                add(m_allocations, stats.allocations);
+                add(m_bytes_allocated, stats.bytes_allocated);
+                std::size_t peak = m_peak_capacity.load(relaxed);
+                if (stats.peak_capacity > peak) {
+                    m_peak_capacity.store(stats.peak_capacity, relaxed);
+                }
+            }
+
+            ArrayDequeStats load() const noexcept {
+                ArrayDequeStats stats;
+                stats.grows = m_grows.load(relaxed);
+                stats.resizes = m_resizes.load(relaxed);
+                stats.bytes_moved = m_bytes_moved.load(relaxed);
+                stats.peak_capacity = m_peak_capacity.load(relaxed);
+                stats.allocations = m_allocations.load(relaxed);
+                stats.bytes_allocated = m_bytes_allocated.load(relaxed);
+                return stats;
+            }
+
+            private:
+            using Counter = std::atomic<std::size_t>;
+            static constexpr auto relaxed = std::memory_order_relaxed;
+
+            static void add(Counter& counter, std::size_t n) noexcept {
+                if (n > 0) {
+                    counter.store(counter.load(relaxed) + n, relaxed);
+                }
+            }
+
+            Counter m_grows {0};
+            Counter m_resizes {0};
+            Counter m_bytes_moved {0};
+            Counter m_peak_capacity {0};
+            Counter m_allocations {0};
+            Counter m_bytes_allocated {0};
+            // Links in the registry's list, guarded by its mutex.
+            ThreadStats* m_prev = nullptr;
+            ThreadStats* m_next = nullptr;
+        };
+
+        inline thread_local ThreadStats thread_stats;
+
+        /**
+         * Gets the combined statistics of all ArrayDeques in the program,
+         * from every thread.
+         */
+        inline ArrayDequeStats array_deque_global_stats() {
+            Registry& reg = registry();
+            std::lock_guard lock(reg.m_mutex);
+            ArrayDequeStats stats = reg.m_exited;
+            const ThreadStats* thread = reg.m_threads;
+            for (; thread; thread = thread->next()) {
+                stats.merge(thread->load());
+            }
+            return stats;
+        }
+
+        /**
+         * Sets a function to call whenever an ArrayDeque's buffer is
+         * resized, or null to remove it. It's called on the thread that
+         * resized the deque, and must not throw.
+         */
+        inline void set_array_deque_resize_hook(ResizeHook hook) noexcept {
+            registry().m_hook.store(hook);
+        }
+
+        /**
+         * Records statistics from one deque operation in the deque's own
+         * counters (`stats`) and the current thread's counters.
+         */
+        inline void record(
+            ArrayDequeStats& stats, const ArrayDequeStats& delta
+        ) noexcept {
+            stats.merge(delta);
+            thread_stats.add(delta);
+        }
+
+        inline void notify_resize(const ResizeEvent& event) noexcept {
+            if (ResizeHook hook = registry().m_hook.load()) {
+                hook(event);
+            }
+        }
+    #endif
+}
+
+namespace utility {
+    /**
+     * Allocation and resizing counters for ArrayDeque. They're collected
+     * only when CXXUTIL_ARRAY_DEQUE_STATS is defined to 1; otherwise the
+     * instrumentation compiles to nothing. With it enabled,
+     * ArrayDeque::stats() gets a deque's own counters.
+     */
+    using detail::array_deque_stats::ArrayDequeStats;
+
+    /**
+     * Describes a resize of an ArrayDeque's buffer (see
+     * set_array_deque_resize_hook()).
+     */
+    using detail::array_deque_stats::ResizeEvent;
+
+    #if CXXUTIL_ARRAY_DEQUE_STATS
+        using detail::array_deque_stats::array_deque_global_stats;
+        using detail::array_deque_stats::set_array_deque_resize_hook;
+    #endif
+}
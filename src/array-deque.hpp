@@ -18,15 +18,23 @@
  */
 
 #pragma once
+#include "array-deque-stats.hpp"
 #include "pow2.hpp"
+#include "span.hpp"
+#include "storage-for.hpp"
 #include "to-address.hpp"
+#include "trivially-relocatable.hpp"
 #include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <new>
+#include <numeric>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
@@ -37,31 +45,231 @@ namespace utility::detail::array_deque {
     using ::utility::to_address;
     using ::utility::pow2_floor;
     using ::utility::pow2_ceil;
+    using ::utility::is_trivially_relocatable_v;
+    using ::utility::span;
+    using ::utility::StorageFor;
+    using ::utility::ArrayDequeStats;
+    using ::utility::ResizeEvent;
+
+    template <
+        typename T,
+        typename Allocator,
+        std::size_t inline_capacity,
+        typename CapacityPolicy
+    >
+    class ArrayDeque;
 
     template <typename T, typename Allocator>
-    class ArrayDeque;
+    class RingBuffer;
+
+    template <typename It>
+    using iterator_category_t = typename std::iterator_traits<
+        It
+    >::iterator_category;
+
+    template <typename It>
+    inline constexpr bool is_forward_iterator_v = std::is_base_of_v<
+        std::forward_iterator_tag, iterator_category_t<It>
+    >;
+
+    /**
+     * Whether elements can be copied from `It` to a buffer of `T` with
+     * std::memcpy().
+     */
+    template <typename T, typename It>
+    inline constexpr bool is_memcpy_source_v = (
+        std::is_pointer_v<It> &&
+        std::is_same_v<std::remove_cv_t<std::remove_pointer_t<It>>, T> &&
+        std::is_trivially_copyable_v<T>
+    );
+
+    /**
+     * Whether elements of type `T` can be copied to `It` with
+     * std::memcpy().
+     */
+    template <typename T, typename It>
+    inline constexpr bool is_memcpy_dest_v = (
+        std::is_same_v<It, T*> && std::is_trivially_copyable_v<T>
+    );
+
+    template <typename Allocator, typename = void>
+    struct has_reallocate : std::false_type {};
+
+    template <typename Allocator>
+    struct has_reallocate<Allocator, std::void_t<decltype(
+        std::declval<Allocator&>().reallocate(
+            std::declval<typename Allocator::value_type*>(),
+            std::size_t(),
+            std::size_t()
+        )
+    )>> : std::is_same<
+        typename std::allocator_traits<Allocator>::pointer,
+        typename Allocator::value_type*
+    > {};
+
+    /**
+     * Whether `Allocator` can resize an allocation, possibly without
+     * copying, with `reallocate(pointer, old_n, n)` (see MmapAllocator).
+     */
+    template <typename Allocator>
+    inline constexpr bool has_reallocate_v = has_reallocate<Allocator>::value;
+
+    /* capacity policies */
+    /* ================= */
+
+    /**
+     * Keeps the capacity a power of 2, so physical indices can be wrapped
+     * with a mask. Growth doubles the capacity.
+     */
+    struct Pow2Capacity {
+        /**
+         * Whether the deque shrinks automatically as elements are removed
+         * (see AutoShrink).
+         */
+        static constexpr bool auto_shrink = false;
+
+        /**
+         * Gets the smallest valid capacity that can hold `n` elements, or
+         * a value less than `n` on overflow.
+         */
+        static constexpr std::size_t fit(std::size_t n) noexcept {
+            return pow2_ceil(n);
+        }
+
+        /**
+         * Gets the largest valid capacity less than or equal to `n`.
+         */
+        static constexpr std::size_t floor(std::size_t n) noexcept {
+            return pow2_floor(n);
+        }
 
+        /**
+         * Gets the capacity to grow to from `capacity`, or a value less
+         * than `capacity` on overflow.
+         */
+        static constexpr std::size_t grow(std::size_t capacity) noexcept {
+            return capacity * 2;
+        }
+
+        /**
+         * Wraps `i` to a physical index. `i` may be anywhere in
+         * [-capacity, 2 * capacity), with negative values stored modulo
+         * 2^N.
+         */
+        static constexpr std::size_t wrap(
+            std::size_t i, std::size_t capacity
+        ) noexcept {
+            return i & (capacity - 1);
+        }
+    };
+
+    /**
+     * Allows any capacity, so `reserve()` and `shrink_to_fit()` don't
+     * round up. Growth multiplies the capacity by `num / den` (1.5 by
+     * default). Physical indices are wrapped with a conditional add or
+     * subtract instead of a mask, which costs a little on each access.
+     */
+    template <std::size_t num = 3, std::size_t den = 2>
+    struct ExactCapacity {
+        static_assert(num > den && den > 0, "growth factor must be > 1");
+
+        static constexpr bool auto_shrink = false;
+
+        static constexpr std::size_t fit(std::size_t n) noexcept {
+            return n;
+        }
+
+        static constexpr std::size_t floor(std::size_t n) noexcept {
+            return n;
+        }
+
+        static constexpr std::size_t grow(std::size_t capacity) noexcept {
+            // Divide first so large capacities don't overflow early.
+            std::size_t extra = std::max<std::size_t>(
+                capacity / den * (num - den) +
+                capacity % den * (num - den) / den,
+                1
+            );
+            return capacity + extra;
+        }
+
+        static constexpr std::size_t wrap(
+            std::size_t i, std::size_t capacity
+        ) noexcept {
+            if (static_cast<std::ptrdiff_t>(i) < 0) {
+                return i + capacity;
+            }
+            return i < capacity ? i : i - capacity;
+        }
+    };
+
+    /**
+     * Wraps another capacity policy so that the deque shrinks when
+     * elements are removed and fewer than 1/`den` of its slots remain
+     * occupied. The new capacity fits twice the remaining elements, so
+     * one bulk removal shrinks all the way in a single resize, and
+     * because the deque is then at most half full, alternating insertions
+     * and removals don't cause repeated resizing.
+     */
+    template <typename Policy = Pow2Capacity, std::size_t den = 4>
+    struct AutoShrink : Policy {
+        static_assert(den > 2, "shrink threshold must be below 1/2");
+
+        static constexpr bool auto_shrink = true;
+
+        /**
+         * Gets the capacity to shrink to, or `capacity` to keep it.
+         */
+        static constexpr std::size_t shrink(
+            std::size_t size, std::size_t capacity
+        ) noexcept {
+            if (size >= capacity / den) {
+                return capacity;
+            }
+            // `size * den` is less than `capacity`, so it can't overflow.
+            return Policy::fit(std::max<std::size_t>(size * den / 2, 1));
+        }
+    };
+
+    /* iterators */
+    /* ========= */
+
+    /**
+     * Iterators store the index of an element before it's wrapped to the
+     * capacity: the deque's head plus the element's offset from the front.
+     * Indices of the same deque therefore increase from front to back, so
+     * ordering and distance are plain integer comparisons and
+     * subtractions, whether or not the elements wrap around the end of the
+     * buffer. This keeps iterators three words long.
+     */
     template <typename T>
     struct IteratorData {
         T* m_buffer = nullptr;
         std::size_t m_capacity = 0;
-        std::size_t m_head = 0;
         std::size_t m_index = 0;
 
         IteratorData() noexcept = default;
 
-        template <typename Allocator>
+        template <
+            typename Allocator,
+            std::size_t inline_capacity,
+            typename CapacityPolicy
+        >
         IteratorData(
-            const ArrayDeque<T, Allocator>& deque, std::size_t i
+            const ArrayDeque<
+                T, Allocator, inline_capacity, CapacityPolicy
+            >& deque,
+            std::size_t i
         ) noexcept :
-        m_buffer(deque.m_buffer),
+        m_buffer(deque.buffer_ptr()),
         m_capacity(deque.m_capacity),
-        m_head(deque.m_head),
-        m_index(i) {
+        m_index(deque.m_head + i) {
         }
 
-        std::size_t mod_capacity(std::size_t i) const noexcept {
-            return i & (m_capacity - 1);
+        // `m_index` is always less than twice the capacity, which a
+        // conditional subtract handles for every capacity policy.
+        std::size_t physical_index() const noexcept {
+            return m_index < m_capacity ? m_index : m_index - m_capacity;
         }
     };
 
@@ -85,15 +293,15 @@ namespace utility::detail::array_deque {
         }
 
         pointer operator->() const noexcept {
-            return const_cast<pointer>(m_buffer + m_index);
+            return m_buffer + physical_index();
         }
 
         reference operator*() const noexcept {
             return *this->operator->();
         }
 
-        reference operator[](std::size_t i) const noexcept {
-            return const_cast<reference>(m_buffer[mod_capacity(m_index + i)]);
+        reference operator[](difference_type i) const noexcept {
+            return *(*this + i);
         }
 
         bool operator==(const Self& other) const noexcept {
@@ -105,10 +313,7 @@ namespace utility::detail::array_deque {
         }
 
         bool operator<(const Self& other) const noexcept {
-            if ((m_index < m_head) == (other.m_index < m_head)) {
-                return m_index < other.m_index;
-            }
-            return m_index >= m_head;
+            return m_index < other.m_index;
         }
 
         bool operator>(const Self& other) const noexcept {
@@ -124,12 +329,12 @@ namespace utility::detail::array_deque {
         }
 
         Self& operator+=(difference_type n) noexcept {
-            m_index = mod_capacity(m_index + n);
+            m_index += n;
             return *this;
         }
 
         Self& operator-=(difference_type n) noexcept {
-            m_index = mod_capacity(m_index - n);
+            m_index -= n;
             return *this;
         }
 
@@ -169,26 +374,260 @@ namespace utility::detail::array_deque {
             return result;
         }
 
-        difference_type operator-(const Self& other) {
+        difference_type operator-(const Self& other) const noexcept {
             return (
                 static_cast<difference_type>(m_index) -
                 static_cast<difference_type>(other.m_index)
             );
         }
 
+        /**
+         * Gets the longest contiguous range of at most `n` elements that
+         * starts at this iterator. If it's shorter than `n`, the next
+         * element is at the start of the buffer.
+         */
+        span<T> segment(std::size_t n) const noexcept {
+            std::size_t i = physical_index();
+            return {m_buffer + i, std::min(n, m_capacity - i)};
+        }
+
+        /**
+         * Gets the longest contiguous range of at most `n` elements that
+         * ends just before this iterator.
+         */
+        span<T> segment_before(std::size_t n) const noexcept {
+            std::size_t i = physical_index();
+            if (i == 0) {
+                i = m_capacity;
+            }
+            std::size_t len = std::min(n, i);
+            return {m_buffer + i - len, len};
+        }
+
         private:
         friend Iterator<const T>;
 
-        template <typename, typename>
+        template <typename, typename, std::size_t, typename>
         friend class ArrayDeque;
 
         using Base::Base;
         using Base::m_buffer;
-        using Base::m_head;
+        using Base::m_capacity;
         using Base::m_index;
-        using Base::mod_capacity;
+        using Base::physical_index;
     };
 
+    /* segmented algorithms */
+    /* ==================== */
+
+    /**
+     * Splits [first, last) into two contiguous ranges in the buffer. The
+     * second range is empty unless the elements wrap around the end of the
+     * buffer.
+     */
+    template <typename T>
+    std::pair<span<T>, span<T>> segments(
+        Iterator<T> first, Iterator<T> last
+    ) noexcept {
+        auto n = static_cast<std::size_t>(last - first);
+        span<T> head = first.segment(n);
+        return {head, (first + head.size()).segment(n - head.size())};
+    }
+
+    /**
+     * Calls `func(a, b, n)` for consecutive pairs of ranges [a, a + n) and
+     * [b, b + n), which are contiguous in both buffers, that together make
+     * up the `n` elements starting at `first1` and `first2`. Stops early if
+     * `func` returns false, in which case this function returns false.
+     */
+    template <typename T, typename U, typename Func>
+    bool for_each_chunk(
+        Iterator<T> first1, Iterator<U> first2, std::size_t n, Func&& func
+    ) {
+        while (n > 0) {
+            span<T> a = first1.segment(n);
+            span<U> b = first2.segment(a.size());
+            if (!func(a.data(), b.data(), b.size())) {
+                return false;
+            }
+            first1 += b.size();
+            first2 += b.size();
+            n -= b.size();
+        }
+        return true;
+    }
+
+    /**
+     * Like for_each_chunk(), but visits the `n` elements that end just
+     * before `last1` and `last2`, starting with the last chunk.
+     */
+    template <typename T, typename U, typename Func>
+    void for_each_chunk_backward(
+        Iterator<T> last1, Iterator<U> last2, std::size_t n, Func&& func
+    ) {
+        while (n > 0) {
+            span<T> a = last1.segment_before(n);
+            span<U> b = last2.segment_before(a.size());
+            func(a.data() + a.size() - b.size(), b.data(), b.size());
+            last1 -= b.size();
+            last2 -= b.size();
+            n -= b.size();
+        }
+    }
+
+    /**
+     * Segmented std::move() between (possibly overlapping) ranges of
+     * ArrayDeque elements.
+     */
+    template <typename T>
+    void segmented_move(
+        Iterator<T> first, Iterator<T> last, Iterator<T> out
+    ) {
+        auto n = static_cast<std::size_t>(last - first);
+        for_each_chunk(first, out, n, [] (T* a, T* b, std::size_t n) {
+            std::move(a, a + n, b);
+            return true;
+        });
+    }
+
+    /**
+     * Segmented std::move_backward() between (possibly overlapping) ranges
+     * of ArrayDeque elements.
+     */
+    template <typename T>
+    void segmented_move_backward(
+        Iterator<T> first, Iterator<T> last, Iterator<T> out_last
+    ) {
+        auto n = static_cast<std::size_t>(last - first);
+        for_each_chunk_backward(last, out_last, n, [] (
+            T* a, T* b, std::size_t n
+        ) {
+            std::move_backward(a, a + n, b + n);
+        });
+    }
+
+    template <typename T, typename Pred>
+    Iterator<T> find_if(Iterator<T> first, Iterator<T> last, Pred pred) {
+        auto [a, b] = segments(first, last);
+        auto it = std::find_if(a.begin(), a.end(), pred);
+        if (it != a.end()) {
+            return first + (it - a.begin());
+        }
+        it = std::find_if(b.begin(), b.end(), pred);
+        return first + (a.size() + (it - b.begin()));
+    }
+
+    template <typename T, typename U>
+    Iterator<T> find(Iterator<T> first, Iterator<T> last, const U& value) {
+        auto [a, b] = segments(first, last);
+        auto it = std::find(a.begin(), a.end(), value);
+        if (it != a.end()) {
+            return first + (it - a.begin());
+        }
+        it = std::find(b.begin(), b.end(), value);
+        return first + (a.size() + (it - b.begin()));
+    }
+
+    template <typename T, typename Func>
+    Func for_each(Iterator<T> first, Iterator<T> last, Func func) {
+        auto [a, b] = segments(first, last);
+        func = std::for_each(a.begin(), a.end(), std::move(func));
+        return std::for_each(b.begin(), b.end(), std::move(func));
+    }
+
+    template <typename T, typename U>
+    void fill(Iterator<T> first, Iterator<T> last, const U& value) {
+        auto [a, b] = segments(first, last);
+        std::fill(a.begin(), a.end(), value);
+        std::fill(b.begin(), b.end(), value);
+    }
+
+    template <typename T, typename Value, typename BinaryOp>
+    Value accumulate(
+        Iterator<T> first, Iterator<T> last, Value init, BinaryOp op
+    ) {
+        auto [a, b] = segments(first, last);
+        init = std::accumulate(a.begin(), a.end(), std::move(init), op);
+        return std::accumulate(b.begin(), b.end(), std::move(init), op);
+    }
+
+    template <typename T, typename Value>
+    Value accumulate(Iterator<T> first, Iterator<T> last, Value init) {
+        auto [a, b] = segments(first, last);
+        init = std::accumulate(a.begin(), a.end(), std::move(init));
+        return std::accumulate(b.begin(), b.end(), std::move(init));
+    }
+
+    template <typename T, typename OutputIt>
+    OutputIt copy(Iterator<T> first, Iterator<T> last, OutputIt out) {
+        auto [a, b] = segments(first, last);
+        out = std::copy(a.begin(), a.end(), out);
+        return std::copy(b.begin(), b.end(), out);
+    }
+
+    template <typename InputIt, typename T>
+    Iterator<T> copy(InputIt first, InputIt last, Iterator<T> out) {
+        if constexpr (is_forward_iterator_v<InputIt>) {
+            auto n = static_cast<std::size_t>(std::distance(first, last));
+            auto [a, b] = segments(out, out + n);
+            InputIt mid = std::next(first, a.size());
+            std::copy(first, mid, a.begin());
+            std::copy(mid, last, b.begin());
+            return out + n;
+        } else {
+            for (; first != last; ++first, ++out) {
+                *out = *first;
+            }
+            return out;
+        }
+    }
+
+    template <typename T, typename U>
+    Iterator<U> copy(Iterator<T> first, Iterator<T> last, Iterator<U> out) {
+        auto n = static_cast<std::size_t>(last - first);
+        for_each_chunk(first, out, n, [] (T* a, U* b, std::size_t n) {
+            std::copy(a, a + n, b);
+            return true;
+        });
+        return out + n;
+    }
+
+    template <typename T, typename U>
+    bool equal(Iterator<T> first1, Iterator<T> last1, Iterator<U> first2) {
+        auto n = static_cast<std::size_t>(last1 - first1);
+        return for_each_chunk(first1, first2, n, [] (
+            T* a, U* b, std::size_t n
+        ) {
+            return std::equal(a, a + n, b);
+        });
+    }
+
+    template <typename T, typename U>
+    bool lexicographical_compare(
+        Iterator<T> first1, Iterator<T> last1,
+        Iterator<U> first2, Iterator<U> last2
+    ) {
+        auto n1 = static_cast<std::size_t>(last1 - first1);
+        auto n2 = static_cast<std::size_t>(last2 - first2);
+        bool less = n1 < n2;
+        for_each_chunk(first1, first2, std::min(n1, n2), [&] (
+            T* a, U* b, std::size_t n
+        ) {
+            for (std::size_t i = 0; i < n; ++i) {
+                if (a[i] < b[i]) {
+                    less = true;
+                    return false;
+                }
+                if (b[i] < a[i]) {
+                    less = false;
+                    return false;
+                }
+            }
+            return true;
+        });
+        return less;
+    }
+
     template <typename Allocator>
     struct ArrayDequeBase : Allocator {
         using AllocTraits = std::allocator_traits<Allocator>;
@@ -211,16 +650,57 @@ namespace utility::detail::array_deque {
         std::size_t m_size = 0;
     };
 
+    /**
+     * Storage for the elements of a SmallArrayDeque until they no longer
+     * fit and are moved to an allocated buffer.
+     */
+    template <typename T, std::size_t N>
+    struct InlineBuffer {
+        StorageFor<T> m_inline_buffer[N];
+
+        T* inline_buffer() const noexcept {
+            return reinterpret_cast<T*>(
+                const_cast<StorageFor<T>*>(m_inline_buffer)
+            );
+        }
+    };
+
+    template <typename T>
+    struct InlineBuffer<T, 0> {
+        T* inline_buffer() const noexcept {
+            return nullptr;
+        }
+    };
+
     // Initial capacity after the first element is inserted.
     inline constexpr std::size_t initial_capacity = 1;
 
-    template <typename T, typename Allocator = std::allocator<T>>
-    class ArrayDeque : ArrayDequeBase<Allocator>, Data {
+    template <
+        typename T,
+        typename Allocator = std::allocator<T>,
+        std::size_t inline_capacity = 0,
+        typename CapacityPolicy = Pow2Capacity
+    >
+    class ArrayDeque :
+    ArrayDequeBase<Allocator>, Data, InlineBuffer<T, inline_capacity> {
         using Self = ArrayDeque;
         using Base = ArrayDequeBase<Allocator>;
         using typename Base::AllocTraits;
         using typename Base::AllocPtr;
 
+        static_assert(
+            CapacityPolicy::fit(inline_capacity) == inline_capacity,
+            "inline capacity must be a valid capacity for the policy"
+        );
+
+        // Whether the elements of another deque can be taken over without
+        // an exception being thrown.
+        static constexpr bool nothrow_steal = (
+            inline_capacity == 0 ||
+            is_trivially_relocatable_v<T> ||
+            std::is_nothrow_move_constructible_v<T>
+        );
+
         public:
         using value_type = T;
         using reference = T&;
@@ -230,9 +710,24 @@ namespace utility::detail::array_deque {
         using difference_type = std::ptrdiff_t;
         using size_type = std::size_t;
 
-        ArrayDeque() noexcept = default;
+        ArrayDeque() noexcept(noexcept(Allocator())) : Self(Allocator()) {
+        }
 
         ArrayDeque(const Allocator& alloc) noexcept : Base {alloc} {
+            reset();
+        }
+
+        template <typename InputIt, typename = iterator_category_t<InputIt>>
+        ArrayDeque(
+            InputIt first, InputIt last, const Allocator& alloc = Allocator()
+        ) : Self(alloc) {
+            append(first, last);
+        }
+
+        ArrayDeque(
+            std::initializer_list<T> list,
+            const Allocator& alloc = Allocator()
+        ) : Self(list.begin(), list.end(), alloc) {
         }
 
         ArrayDeque(const Self& other) :
@@ -256,7 +751,7 @@ namespace utility::detail::array_deque {
         ) {
         }
 
-        ArrayDeque(Self&& other) noexcept :
+        ArrayDeque(Self&& other) noexcept(nothrow_steal) :
         Self(move_t(), std::move(other), std::move(other.allocator())) {
         }
 
@@ -273,10 +768,10 @@ namespace utility::detail::array_deque {
             return *this;
         }
 
-        Self& operator=(Self&& other) noexcept(
+        Self& operator=(Self&& other) noexcept(nothrow_steal && (
             AllocTraits::propagate_on_container_move_assignment::value ||
             AllocTraits::is_always_equal::value
-        ) {
+        )) {
             constexpr bool propagate = (
                 AllocTraits::propagate_on_container_move_assignment::value
             );
@@ -288,17 +783,19 @@ namespace utility::detail::array_deque {
             return *this;
         }
 
+        Self& operator=(std::initializer_list<T> list) {
+            assign(list);
+            return *this;
+        }
+
         ~ArrayDeque() {
-            for (std::size_t i = 0; i < size(); ++i) {
-                destroy(buffer_ptr(i));
-            }
-            deallocate(m_buffer, capacity());
+            destroy();
         }
 
-        void swap(Self& other) noexcept(
+        void swap(Self& other) noexcept(nothrow_steal && (
             AllocTraits::propagate_on_container_move_assignment::value ||
             AllocTraits::is_always_equal::value
-        ) {
+        )) {
             constexpr bool propagate = (
                 AllocTraits::propagate_on_container_swap::value
             );
@@ -322,7 +819,7 @@ namespace utility::detail::array_deque {
             if (size() != other.size()) {
                 return false;
             }
-            return std::equal(begin(), end(), other.begin());
+            return array_deque::equal(begin(), end(), other.begin());
         }
 
         bool operator!=(const Self& other) const {
@@ -330,7 +827,7 @@ namespace utility::detail::array_deque {
         }
 
         bool operator<(const Self& other) const {
-            return std::lexicographical_compare(
+            return array_deque::lexicographical_compare(
                 begin(), end(), other.begin(), other.end()
             );
         }
@@ -359,7 +856,7 @@ namespace utility::detail::array_deque {
         }
 
         std::size_t max_size() const noexcept {
-            return pow2_floor(AllocTraits::max_size(allocator()));
+            return CapacityPolicy::floor(AllocTraits::max_size(allocator()));
         }
 
         [[nodiscard]] bool empty() const noexcept {
@@ -433,16 +930,16 @@ namespace utility::detail::array_deque {
         template <typename... Args>
         void emplace_front(Args&&... args) {
             ensure_capacity();
-            construct(buffer_ptr(m_head), std::forward<Args>(args)...);
-            m_head = mod_capacity(m_head - 1);
+            std::size_t head = mod_capacity(m_head - 1);
+            construct(buffer_ptr(head), std::forward<Args>(args)...);
+            m_head = head;
             ++m_size;
         }
 
         template <typename... Args>
         void emplace_back(Args&&... args) {
             ensure_capacity();
-            construct(item_ptr(size()), std::forward<Args>(args)...);
-            ++m_size;
+            emplace_back_unchecked(std::forward<Args>(args)...);
         }
 
         void pop_front() noexcept {
@@ -450,12 +947,66 @@ namespace utility::detail::array_deque {
             destroy(buffer_ptr(m_head));
             m_head = mod_capacity(m_head + 1);
             --m_size;
+            maybe_shrink();
         }
 
         void pop_back() noexcept {
             assert(!empty());
             destroy(item_ptr(m_size - 1));
             --m_size;
+            maybe_shrink();
+        }
+
+        /**
+         * Removes the first `n` elements, which must not be more than the
+         * size.
+         */
+        void pop_front_n(std::size_t n) noexcept {
+            assert(n <= size());
+            destroy_range(0, n);
+            m_head = mod_capacity(m_head + n);
+            m_size -= n;
+            maybe_shrink();
+        }
+
+        /**
+         * Removes the last `n` elements, which must not be more than the
+         * size.
+         */
+        void pop_back_n(std::size_t n) noexcept {
+            assert(n <= size());
+            destroy_range(size() - n, n);
+            m_size -= n;
+            maybe_shrink();
+        }
+
+        /**
+         * Removes up to `n` elements from the front and move-assigns them
+         * to the range starting at `out`, and returns the number of
+         * elements removed. Elements are moved one contiguous segment at a
+         * time (with std::memcpy() when `out` is a `T*` and `T` is
+         * trivially copyable), and the front of the deque is advanced
+         * once.
+         */
+        template <typename OutputIt>
+        std::size_t drain_front(OutputIt out, std::size_t n) {
+            n = std::min(n, size());
+            if (n == 0) {
+                return 0;
+            }
+            auto [first, second] = segments(begin(), begin() + n);
+            if constexpr (is_memcpy_dest_v<T, OutputIt>) {
+                std::memcpy(out, first.data(), first.size_bytes());
+                out += first.size();
+                if (!second.empty()) {
+                    std::memcpy(out, second.data(), second.size_bytes());
+                }
+            } else {
+                out = std::move(first.begin(), first.end(), out);
+                std::move(second.begin(), second.end(), out);
+            }
+            pop_front_n(n);
+            return n;
         }
 
         void clear() noexcept {
@@ -463,14 +1014,268 @@ namespace utility::detail::array_deque {
             reset();
         }
 
+        /**
+         * Removes all elements but keeps the buffer, so that elements can
+         * be inserted again without allocating.
+         */
+        void clear_keep_capacity() noexcept {
+            destroy_items();
+            m_head = 0;
+        }
+
+        /**
+         * Changes the number of elements to `n`. Elements are removed from
+         * the back, or value-initialized elements are appended. The buffer
+         * is resized at most once.
+         */
+        void resize(std::size_t n) {
+            resize_with(n, [this](T* item) {
+                construct(item);
+            });
+        }
+
+        /**
+         * Changes the number of elements to `n`. Elements are removed from
+         * the back, or copies of `value` are appended. The buffer is
+         * resized at most once.
+         */
+        void resize(std::size_t n, const T& value) {
+            resize_with(n, [this, &value](T* item) {
+                construct(item, value);
+            });
+        }
+
+        /**
+         * Like resize(), but appended elements are default-initialized
+         * instead of value-initialized, so trivial types are left
+         * uninitialized and can be written to afterwards (e.g., through
+         * as_spans()). The allocator's `construct()` is not used.
+         */
+        void resize_default_init(std::size_t n) {
+            if constexpr (std::is_trivially_default_constructible_v<T>) {
+                if (n > size()) {
+                    reserve_additional(n - size());
+                    m_size = n;
+                    return;
+                }
+            }
+            resize_with(n, [](T* item) {
+                ::new (static_cast<void*>(item)) T;
+            });
+        }
+
+        /**
+         * Inserts copies of the elements in [first, last) after the last
+         * element. For forward iterators, the buffer is resized at most
+         * once. If an exception is thrown, the deque's elements are left
+         * unchanged.
+         */
+        template <typename InputIt, typename = iterator_category_t<InputIt>>
+        void append(InputIt first, InputIt last) {
+            if constexpr (is_forward_iterator_v<InputIt>) {
+                auto n = static_cast<std::size_t>(std::distance(first, last));
+                reserve_additional(n);
+                construct_items(mod_capacity(m_head + size()), first, n);
+                m_size += n;
+            } else {
+                std::size_t old_size = size();
+                try {
+                    for (; first != last; ++first) {
+                        emplace_back(*first);
+                    }
+                } catch (...) {
+                    while (size() > old_size) {
+                        pop_back();
+                    }
+                    throw;
+                }
+            }
+        }
+
+        void append(std::initializer_list<T> list) {
+            append(list.begin(), list.end());
+        }
+
+        /**
+         * Inserts copies of the elements in [first, last) before the first
+         * element, preserving their order. For forward iterators, the
+         * buffer is resized at most once. If an exception is thrown, the
+         * deque's elements are left unchanged.
+         */
+        template <typename InputIt, typename = iterator_category_t<InputIt>>
+        void prepend(InputIt first, InputIt last) {
+            if constexpr (is_forward_iterator_v<InputIt>) {
+                auto n = static_cast<std::size_t>(std::distance(first, last));
+                reserve_additional(n);
+                std::size_t head = mod_capacity(m_head - n);
+                construct_items(head, first, n);
+                m_head = head;
+                m_size += n;
+            } else {
+                std::size_t old_size = size();
+                try {
+                    for (; first != last; ++first) {
+                        emplace_front(*first);
+                    }
+                } catch (...) {
+                    while (size() > old_size) {
+                        pop_front();
+                    }
+                    throw;
+                }
+                std::size_t n = size() - old_size;
+                for (std::size_t i = 0; i < n / 2; ++i) {
+                    using std::swap;
+                    swap(*item_ptr(i), *item_ptr(n - 1 - i));
+                }
+            }
+        }
+
+        void prepend(std::initializer_list<T> list) {
+            prepend(list.begin(), list.end());
+        }
+
+        /**
+         * Replaces the contents of the deque with copies of the elements in
+         * [first, last). For forward iterators, the existing buffer is
+         * reused if it is large enough; otherwise, a single buffer of the
+         * required size is allocated.
+         */
+        template <typename InputIt, typename = iterator_category_t<InputIt>>
+        void assign(InputIt first, InputIt last) {
+            if constexpr (is_forward_iterator_v<InputIt>) {
+                auto n = static_cast<std::size_t>(std::distance(first, last));
+                std::size_t new_capacity = capacity_for(n);
+                destroy_items();
+                m_head = 0;
+                if (new_capacity > capacity()) {
+                    deallocate(m_buffer, capacity());
+                    reset();
+                    init_buffer(new_capacity);
+                }
+                construct_items(0, first, n);
+                m_size = n;
+            } else {
+                destroy_items();
+                m_head = 0;
+                append(first, last);
+            }
+        }
+
+        void assign(std::initializer_list<T> list) {
+            assign(list.begin(), list.end());
+        }
+
+        /**
+         * Inserts copies of the elements in [first, last) before `pos`.
+         * The elements on the shorter side of `pos` are shifted, so at most
+         * half of the existing elements are moved. Trivially relocatable
+         * elements are shifted with memmove(); others are shifted by
+         * inserting at the nearer end and rotating, which gives the basic
+         * exception guarantee. Returns an iterator to the first inserted
+         * element.
+         */
+        template <typename InputIt, typename = iterator_category_t<InputIt>>
+        iterator insert(const_iterator pos, InputIt first, InputIt last) {
+            if constexpr (is_forward_iterator_v<InputIt>) {
+                auto n = static_cast<std::size_t>(std::distance(first, last));
+                return insert_n(pos - cbegin(), first, n);
+            } else {
+                Self items(first, last, allocator());
+                return insert(
+                    pos,
+                    std::make_move_iterator(items.begin()),
+                    std::make_move_iterator(items.end())
+                );
+            }
+        }
+
+        iterator insert(const_iterator pos, std::initializer_list<T> list) {
+            return insert(pos, list.begin(), list.end());
+        }
+
+        iterator insert(const_iterator pos, const T& obj) {
+            return emplace(pos, obj);
+        }
+
+        iterator insert(const_iterator pos, T&& obj) {
+            return emplace(pos, std::move(obj));
+        }
+
+        template <typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args) {
+            std::size_t i = pos - cbegin();
+            if (i == 0) {
+                emplace_front(std::forward<Args>(args)...);
+                return begin();
+            }
+            if (i == size()) {
+                emplace_back(std::forward<Args>(args)...);
+                return end() - 1;
+            }
+            T item(std::forward<Args>(args)...);
+            return insert_n(i, std::make_move_iterator(&item), 1);
+        }
+
+        /**
+         * Removes the elements in [first, last). The elements on the
+         * shorter side of the range are shifted to close the gap, with
+         * memmove() for trivially relocatable elements or segment-wise
+         * move assignment otherwise. Returns an iterator to the element
+         * after the removed ones. With AutoShrink, the buffer may then
+         * shrink, which invalidates all other iterators.
+         */
+        iterator erase(const_iterator first, const_iterator last) {
+            std::size_t i = first - cbegin();
+            std::size_t j = last - cbegin();
+            std::size_t n = j - i;
+            if (n == 0) {
+                return begin() + i;
+            }
+            if constexpr (is_trivially_relocatable_v<T>) {
+                for (std::size_t k = i; k < j; ++k) {
+                    destroy(item_ptr(k));
+                }
+            }
+            if (i < size() - j) {
+                if constexpr (is_trivially_relocatable_v<T>) {
+                    relocate_within(0, n, i);
+                } else {
+                    segmented_move_backward(
+                        begin(), begin() + i, begin() + j
+                    );
+                    for (std::size_t k = 0; k < n; ++k) {
+                        destroy(item_ptr(k));
+                    }
+                }
+                m_head = mod_capacity(m_head + n);
+            } else {
+                if constexpr (is_trivially_relocatable_v<T>) {
+                    relocate_within(j, i, size() - j);
+                } else {
+                    segmented_move(begin() + j, end(), begin() + i);
+                    for (std::size_t k = size() - n; k < size(); ++k) {
+                        destroy(item_ptr(k));
+                    }
+                }
+            }
+            m_size -= n;
+            maybe_shrink();
+            return begin() + i;
+        }
+
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+
         template <std::size_t capacity>
         void reserve() {
-            constexpr auto real_capacity = pow2_ceil(capacity);
+            constexpr auto real_capacity = CapacityPolicy::fit(capacity);
             reserve_unchecked(real_capacity);
         }
 
         void reserve(std::size_t capacity) {
-            reserve_unchecked(pow2_ceil(capacity));
+            reserve_unchecked(capacity_for(capacity));
         }
 
         void reserve_log(std::size_t log_capacity) {
@@ -478,12 +1283,103 @@ namespace utility::detail::array_deque {
         }
 
         void shrink_to_fit() {
-            std::size_t new_capacity = pow2_ceil(size());
+            std::size_t new_capacity = std::max(
+                CapacityPolicy::fit(size()), inline_capacity
+            );
             if (new_capacity < capacity()) {
-                resize(new_capacity);
+                set_capacity(new_capacity);
             }
         }
 
+        /* contiguous views */
+        /* ================ */
+
+        /**
+         * Gets the elements as two contiguous ranges in the buffer. The
+         * first range starts with the first element; the second range is
+         * empty unless the elements wrap around the end of the buffer, in
+         * which case it starts at the beginning of the buffer.
+         */
+        std::pair<span<const T>, span<const T>> as_spans() const noexcept {
+            std::size_t n = head_segment_size();
+            return {{buffer_ptr(m_head), n}, {buffer_ptr(), size() - n}};
+        }
+
+        std::pair<span<T>, span<T>> as_spans() noexcept {
+            std::size_t n = head_segment_size();
+            return {{buffer_ptr(m_head), n}, {buffer_ptr(), size() - n}};
+        }
+
+        /**
+         * Moves the elements so that they're contiguous in the buffer, and
+         * returns them as a single range. If they wrap around the end of
+         * the buffer, they're moved to the start of it; otherwise, nothing
+         * is moved. No memory is allocated.
+         *
+         * If moving an element throws, the elements that haven't been
+         * moved yet are destroyed, and the rest remain in an unspecified
+         * order.
+         */
+        span<T> make_contiguous() {
+            std::size_t front = head_segment_size();
+            std::size_t back = size() - front;
+            if (back == 0) {
+                return {buffer_ptr(m_head), size()};
+            }
+            T* buffer = buffer_ptr();
+            std::size_t gap = capacity() - size();
+            if constexpr (is_trivially_relocatable_v<T>) {
+                if (front <= gap) {
+                    // Shift the back part up and copy the front part below
+                    // it; neither overlaps the other's destination.
+                    std::memmove(
+                        static_cast<void*>(buffer + front), buffer,
+                        back * sizeof(T)
+                    );
+                    std::memcpy(
+                        static_cast<void*>(buffer), buffer + m_head,
+                        front * sizeof(T)
+                    );
+                    m_head = 0;
+                    return {buffer, size()};
+                }
+                std::memmove(
+                    static_cast<void*>(buffer + back), buffer + m_head,
+                    front * sizeof(T)
+                );
+            } else if (gap > 0) {
+                close_gap(back, front);
+            }
+            // The back part is now at the start of the buffer, followed
+            // directly by the front part.
+            m_head = 0;
+            std::rotate(buffer, buffer + back, buffer + size());
+            return {buffer, size()};
+        }
+
+        /**
+         * Gets the unoccupied slots after the last element as two
+         * contiguous ranges of uninitialized memory, in order. Elements
+         * constructed in these slots can be added to the deque with
+         * commit_back().
+         */
+        std::pair<span<T>, span<T>> free_spans() noexcept {
+            std::size_t tail = mod_capacity(m_head + size());
+            std::size_t free = capacity() - size();
+            std::size_t n = std::min(free, capacity() - tail);
+            return {{buffer_ptr(tail), n}, {buffer_ptr(), free - n}};
+        }
+
+        /**
+         * Adds the `n` elements that the caller has constructed at the
+         * start of the ranges returned by free_spans() to the back of the
+         * deque.
+         */
+        void commit_back(std::size_t n) noexcept {
+            assert(n <= capacity() - size());
+            m_size += n;
+        }
+
         /* iteration */
         /* ========= */
 
@@ -503,11 +1399,37 @@ namespace utility::detail::array_deque {
             return {*this, size()};
         }
 
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+        #if CXXUTIL_ARRAY_DEQUE_STATS
+            /**
+             * Gets allocation and resizing statistics for this deque.
+             * Available only when CXXUTIL_ARRAY_DEQUE_STATS is enabled.
+             * The statistics belong to the contents: moving a deque moves
+             * them, and swapping two deques swaps them.
+             */
+            const ArrayDequeStats& stats() const noexcept {
+                return m_stats;
+            }
+        #endif
+
         /* private members */
         /* =============== */
 
         private:
         friend IteratorData<T>;
+
+        using Policy = CapacityPolicy;
+
+        template <typename, typename>
+        friend class RingBuffer;
+
         using Base::m_buffer;
         using Base::allocator;
 
@@ -520,25 +1442,19 @@ namespace utility::detail::array_deque {
          */
         template <typename Alloc>
         ArrayDeque(copy_t, const Self& other, Alloc&& alloc) :
-        Base {std::forward<Alloc>(alloc), allocate(other.m_capacity)},
-        Data {other.m_capacity} {
-            try {
-                for (; m_size < other.size(); ++m_size) {
-                    construct(buffer_ptr(m_size), other[m_size]);
-                }
-            } catch (...) {
-                destroy();
-                throw;
-            }
+        Self(std::forward<Alloc>(alloc)) {
+            reserve_unchecked(other.capacity());
+            construct_from(other);
         }
 
         /**
          * Generic move constructor.
          */
         template <typename Alloc>
-        ArrayDeque(move_t, Self&& other, Alloc&& alloc) :
-        Base {std::forward<Alloc>(alloc), other.m_buffer}, Data(other) {
-            other.reset();
+        ArrayDeque(move_t, Self&& other, Alloc&& alloc) noexcept(
+            nothrow_steal
+        ) : Self(std::forward<Alloc>(alloc)) {
+            steal(other);
         }
 
         /**
@@ -546,16 +1462,35 @@ namespace utility::detail::array_deque {
          */
         ArrayDeque(move_items_t, Self&& other, const Allocator& alloc) :
         Self(alloc) {
-            try {
-                for (; m_size < other.size(); ++m_size) {
-                    construct(buffer_ptr(m_size), std::move(other[m_size]));
-                }
-            } catch (...) {
-                destroy();
-                throw;
+            reserve_unchecked(other.capacity());
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                construct_from(other);
+            } else {
+                construct_items(
+                    0, std::make_move_iterator(other.begin()), other.size()
+                );
+                m_size = other.size();
             }
         }
 
+        /**
+         * Copy-constructs the elements of `other` at the start of the
+         * buffer, which must be empty and large enough, one contiguous
+         * segment at a time (with std::memcpy() for trivially copyable
+         * types).
+         */
+        void construct_from(const Self& other) {
+            assert(empty() && capacity() >= other.size());
+            m_head = 0;
+            auto [first, second] = other.as_spans();
+            construct_contiguous(buffer_ptr(), first.data(), first.size());
+            m_size = first.size();
+            construct_contiguous(
+                buffer_ptr(m_size), second.data(), second.size()
+            );
+            m_size = other.size();
+        }
+
         /**
          * Move-assigns or move-constructs each element, but doesn't reuse
          * memory.
@@ -577,6 +1512,17 @@ namespace utility::detail::array_deque {
          */
         template <typename ItemType, typename Other>
         void assign_items(Other&& other) {
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                // Overwrite everything, reusing the buffer if it's large
+                // enough.
+                if (&other == this) {
+                    return;
+                }
+                m_size = 0;
+                reserve_unchecked(capacity_for(other.size()));
+                construct_from(other);
+                return;
+            }
             std::size_t i = 0;
             std::size_t min_size = std::min(size(), other.size());
 
@@ -593,17 +1539,136 @@ namespace utility::detail::array_deque {
 
         /**
          * Swaps members with another object, including the allocator.
+         * Elements in an inline buffer are relocated to the other object's
+         * inline buffer.
          */
-        void swap_members(Self& other) noexcept {
+        void swap_members(Self& other) noexcept(nothrow_steal) {
             using std::swap;
+            if constexpr (inline_capacity > 0) {
+                if (is_inline() || other.is_inline()) {
+                    Self temp(allocator());
+                    temp.steal(*this);
+                    steal(other);
+                    other.steal(temp);
+                    swap(allocator(), other.allocator());
+                    return;
+                }
+            }
             swap(static_cast<Data&>(*this), static_cast<Data&>(other));
             swap(allocator(), other.allocator());
             swap(m_buffer, other.m_buffer);
+            #if CXXUTIL_ARRAY_DEQUE_STATS
+                swap(m_stats, other.m_stats);
+            #endif
+        }
+
+        /**
+         * Takes ownership of the elements in `other`, leaving it empty.
+         * This deque must be empty and must not own an allocated buffer.
+         */
+        void steal(Self& other) noexcept(nothrow_steal) {
+            assert(empty() && (is_inline() || !m_buffer));
+            #if CXXUTIL_ARRAY_DEQUE_STATS
+                m_stats = std::exchange(other.m_stats, ArrayDequeStats());
+            #endif
+            if (!other.is_inline()) {
+                m_buffer = other.m_buffer;
+                static_cast<Data&>(*this) = other;
+                other.reset();
+                return;
+            }
+            if constexpr (is_trivially_relocatable_v<T>) {
+                other.relocate_items(buffer_ptr());
+            } else {
+                other.move_items_to(buffer_ptr());
+            }
+            m_size = other.size();
+            other.m_head = 0;
+            other.m_size = 0;
+        }
+
+        /**
+         * Moves the `front` elements at the end of the buffer down so that
+         * they directly follow the `back` elements at its start.
+         */
+        void close_gap(std::size_t back, std::size_t front) {
+            T* buffer = buffer_ptr();
+            std::size_t i = 0;
+            try {
+                for (; i < front; ++i) {
+                    T* item = buffer + m_head + i;
+                    construct(buffer + back + i, std::move(*item));
+                    destroy(item);
+                }
+            } catch (...) {
+                for (std::size_t j = i; j < front; ++j) {
+                    destroy(buffer + m_head + j);
+                }
+                m_head = 0;
+                m_size = back + i;
+                throw;
+            }
+        }
+
+        /* fixed-capacity insertion */
+        /* ======================== */
+
+        template <typename... Args>
+        void emplace_back_unchecked(Args&&... args) {
+            assert(size() < capacity());
+            construct(item_ptr(size()), std::forward<Args>(args)...);
+            ++m_size;
+        }
+
+        /**
+         * Inserts an element at the back without resizing. If the buffer
+         * is full, the first element is removed. The capacity must be
+         * nonzero.
+         */
+        template <typename... Args>
+        void emplace_back_overwrite(Args&&... args) {
+            assert(capacity() > 0);
+            constexpr bool branchless = (
+                std::is_trivially_destructible_v<T> &&
+                std::is_nothrow_constructible_v<T, Args&&...>
+            );
+            if constexpr (branchless) {
+                // When the buffer is full, the slot after the last element
+                // holds the first element, which is simply overwritten.
+                bool full = size() == capacity();
+                construct(item_ptr(size()), std::forward<Args>(args)...);
+                m_head = mod_capacity(m_head + full);
+                m_size += !full;
+            } else {
+                if (size() == capacity()) {
+                    pop_front();
+                }
+                emplace_back_unchecked(std::forward<Args>(args)...);
+            }
         }
 
         /* resizing */
         /* ======== */
 
+        /**
+         * Shrinks the buffer if the capacity policy asks for it. Failure to
+         * allocate the smaller buffer is ignored.
+         */
+        void maybe_shrink() noexcept {
+            if constexpr (Policy::auto_shrink) {
+                std::size_t new_capacity = std::max(
+                    Policy::shrink(size(), capacity()), inline_capacity
+                );
+                if (new_capacity >= capacity()) {
+                    return;
+                }
+                try {
+                    set_capacity(new_capacity);
+                } catch (...) {
+                }
+            }
+        }
+
         void ensure_capacity() {
             if (size() < capacity()) {
                 return;
@@ -621,34 +1686,173 @@ namespace utility::detail::array_deque {
         }
 
         void grow_buffer() {
-            std::size_t new_capacity = capacity() * 2;
+            std::size_t new_capacity = Policy::grow(capacity());
             if (new_capacity < capacity()) {
                 throw std::runtime_error("ArrayDeque: capacity overflow");
             }
-            resize(new_capacity);
+            set_capacity(new_capacity);
+            #if CXXUTIL_ARRAY_DEQUE_STATS
+                ArrayDequeStats delta;
+                delta.grows = 1;
+                array_deque_stats::record(m_stats, delta);
+            #endif
+        }
+
+        void set_capacity(std::size_t new_capacity) {
+            assert(new_capacity >= size());
+            std::size_t old_capacity = capacity();
+            constexpr bool can_reallocate = (
+                is_trivially_relocatable_v<T> && has_reallocate_v<Allocator>
+            );
+            if constexpr (can_reallocate) {
+                if (new_capacity > capacity() && m_buffer && !is_inline()) {
+                    std::size_t moved = reallocate(new_capacity);
+                    record_resize(old_capacity, moved);
+                    return;
+                }
+            }
+            AllocPtr new_buffer = allocate(new_capacity);
+            if constexpr (is_trivially_relocatable_v<T>) {
+                relocate_items(to_address(new_buffer));
+            } else {
+                try {
+                    move_items_to(to_address(new_buffer));
+                } catch (...) {
+                    deallocate(new_buffer, new_capacity);
+                    throw;
+                }
+            }
+            deallocate(m_buffer, capacity());
+            m_buffer = new_buffer;
+            m_capacity = new_capacity;
+            m_head = 0;
+            record_resize(old_capacity, size());
         }
 
-        void resize(std::size_t new_capacity) {
-            Data old_data = *this;
-            auto old_buffer = m_buffer;
-            auto it = begin();
-            auto end = this->end();
+        /**
+         * Updates statistics, if enabled, after the buffer was resized
+         * from `old_capacity` and `moved` elements were moved.
+         */
+        void record_resize(
+            [[maybe_unused]] std::size_t old_capacity,
+            [[maybe_unused]] std::size_t moved
+        ) noexcept {
+            #if CXXUTIL_ARRAY_DEQUE_STATS
+                ArrayDequeStats delta;
+                delta.resizes = 1;
+                delta.bytes_moved = moved * sizeof(T);
+                array_deque_stats::record(m_stats, delta);
+                array_deque_stats::notify_resize(ResizeEvent{
+                    this, sizeof(T), size(), old_capacity, capacity(),
+                    delta.bytes_moved,
+                });
+            #endif
+        }
 
-            m_buffer = allocate(new_capacity);
+        /**
+         * Grows the buffer with the allocator's `reallocate()`, which keeps
+         * the elements in place. Only the elements that wrapped around the
+         * end of the old buffer are then moved: either the part at the
+         * start of the buffer to the new space after the old end, or the
+         * part at the end of the old buffer to the end of the new one,
+         * whichever is smaller. Returns the number of elements moved.
+         */
+        std::size_t reallocate(std::size_t new_capacity) {
+            std::size_t old_capacity = capacity();
+            m_buffer = allocator().reallocate(
+                m_buffer, old_capacity, new_capacity
+            );
             m_capacity = new_capacity;
-            m_head = 0;
-            m_size = 0;
+            record_allocation(new_capacity);
+            std::size_t front_size = std::min(size(), old_capacity - m_head);
+            std::size_t back_size = size() - front_size;
+            if (back_size == 0) {
+                return 0;
+            }
+            std::size_t added = new_capacity - old_capacity;
+            if (back_size <= front_size && back_size <= added) {
+                std::memcpy(
+                    static_cast<void*>(buffer_ptr(old_capacity)),
+                    buffer_ptr(), back_size * sizeof(T)
+                );
+                return back_size;
+            }
+            std::size_t head = new_capacity - front_size;
+            std::memmove(
+                static_cast<void*>(buffer_ptr(head)), buffer_ptr(m_head),
+                front_size * sizeof(T)
+            );
+            m_head = head;
+            return front_size;
+        }
 
+        /**
+         * Copies the bytes of each element to `dest`, in order. The
+         * elements in the current buffer must then be considered destroyed.
+         */
+        void relocate_items(T* dest) noexcept {
+            if (empty()) {
+                return;
+            }
+            auto [first, second] = as_spans();
+            std::memcpy(
+                static_cast<void*>(dest), first.data(), first.size_bytes()
+            );
+            std::memcpy(
+                static_cast<void*>(dest + first.size()), second.data(),
+                second.size_bytes()
+            );
+        }
+
+        /**
+         * Move-constructs each element in `dest`, in order, and then
+         * destroys the moved-from elements. If an exception is thrown,
+         * this object is left unchanged.
+         */
+        void move_items_to(T* dest) {
+            std::size_t i = 0;
             try {
-                for (; it != end; ++it, ++m_size) {
-                    construct(buffer_ptr(m_size), std::move(*it));
+                for (; i < size(); ++i) {
+                    construct(dest + i, std::move(*item_ptr(i)));
                 }
             } catch (...) {
-                destroy();
-                m_buffer = old_buffer;
-                static_cast<Data&>(*this) = old_data;
+                destroy_contiguous(dest, i);
                 throw;
             }
+            for (i = 0; i < size(); ++i) {
+                destroy(item_ptr(i));
+            }
+        }
+
+        /**
+         * Gets the capacity needed to hold `n` elements.
+         */
+        std::size_t capacity_for(std::size_t n) const {
+            std::size_t capacity = Policy::fit(n);
+            if (capacity < n) {
+                throw std::runtime_error("ArrayDeque: capacity overflow");
+            }
+            return capacity;
+        }
+
+        /**
+         * Ensures that `n` more elements can be inserted without resizing.
+         */
+        void reserve_additional(std::size_t n) {
+            if (n <= capacity() - size()) {
+                return;
+            }
+            if (size() + n < n) {
+                throw std::runtime_error("ArrayDeque: capacity overflow");
+            }
+            // Grow by at least the policy's factor so that repeated
+            // insertions stay amortized O(1).
+            std::size_t new_capacity = capacity_for(size() + n);
+            std::size_t grown = Policy::grow(capacity());
+            if (grown > new_capacity) {
+                new_capacity = grown;
+            }
+            reserve_unchecked(new_capacity);
         }
 
         void reserve_unchecked(std::size_t new_capacity) {
@@ -656,43 +1860,245 @@ namespace utility::detail::array_deque {
                 return;
             }
             if (m_buffer) {
-                resize(new_capacity);
+                set_capacity(new_capacity);
             } else {
                 init_buffer(new_capacity);
             }
         }
 
+        /* middle insertion */
+        /* ================ */
+
+        /**
+         * Implements insert() for `n` elements at logical index `i`.
+         */
+        template <typename ForwardIt>
+        iterator insert_n(std::size_t i, ForwardIt first, std::size_t n) {
+            bool front = i < size() - i;
+            if constexpr (is_trivially_relocatable_v<T>) {
+                reserve_additional(n);
+                // Open a gap of `n` slots at `i` by shifting the shorter
+                // side, then construct the new elements in it.
+                std::size_t from = front ? 0 : i;
+                std::size_t to = front ? -n : i + n;
+                std::size_t count = front ? i : size() - i;
+                relocate_within(from, to, count);
+                if (front) {
+                    m_head = mod_capacity(m_head - n);
+                }
+                m_size += n;
+                try {
+                    construct_items(mod_capacity(m_head + i), first, n);
+                } catch (...) {
+                    m_size -= n;
+                    if (front) {
+                        m_head = mod_capacity(m_head + n);
+                    }
+                    relocate_within(to, from, count);
+                    throw;
+                }
+            } else if (front) {
+                prepend(first, std::next(first, n));
+                std::rotate(begin(), begin() + n, begin() + (n + i));
+            } else {
+                std::size_t old_size = size();
+                append(first, std::next(first, n));
+                std::rotate(begin() + i, begin() + old_size, end());
+            }
+            return begin() + i;
+        }
+
+        /**
+         * Moves the bytes of the `n` elements starting at logical index
+         * `from` so that they start at logical index `to`, which may be
+         * "negative" (wrapped). The ranges may overlap, and the slots are
+         * treated as raw memory.
+         */
+        void relocate_within(
+            std::size_t from, std::size_t to, std::size_t n
+        ) noexcept {
+            auto func = [] (T* a, T* b, std::size_t len) {
+                std::memmove(
+                    static_cast<void*>(b), static_cast<void*>(a),
+                    len * sizeof(T)
+                );
+                return true;
+            };
+            iterator src = wrapped_iterator(from);
+            iterator dest = wrapped_iterator(to);
+            if (static_cast<std::ptrdiff_t>(to - from) < 0) {
+                for_each_chunk(src, dest, n, func);
+            } else {
+                for_each_chunk_backward(src + n, dest + n, n, func);
+            }
+        }
+
+        /**
+         * Gets an iterator to logical index `i`, which may be "negative"
+         * (wrapped). Its index is reduced below the capacity, so it can
+         * be advanced by up to the capacity and still be valid for
+         * physical_index().
+         */
+        iterator wrapped_iterator(std::size_t i) noexcept {
+            iterator it = begin();
+            it.m_index = mod_capacity(m_head + i);
+            return it;
+        }
+
+        /* bulk construction */
+        /* ================= */
+
+        /**
+         * Constructs `n` elements from the range starting at `first` in
+         * unoccupied buffer slots, starting at physical index `start` and
+         * wrapping around to the start of the buffer if necessary. If an
+         * exception is thrown, the newly constructed elements are destroyed.
+         */
+        template <typename ForwardIt>
+        void construct_items(
+            std::size_t start, ForwardIt first, std::size_t n
+        ) {
+            std::size_t n1 = std::min(n, capacity() - start);
+            first = construct_contiguous(buffer_ptr(start), first, n1);
+            try {
+                construct_contiguous(buffer_ptr(), first, n - n1);
+            } catch (...) {
+                destroy_contiguous(buffer_ptr(start), n1);
+                throw;
+            }
+        }
+
+        /**
+         * Constructs `n` elements from the range starting at `first` in
+         * the uninitialized memory at `dest`, and returns the iterator past
+         * the last element used. If an exception is thrown, the newly
+         * constructed elements are destroyed.
+         */
+        template <typename ForwardIt>
+        ForwardIt construct_contiguous(
+            T* dest, ForwardIt first, std::size_t n
+        ) {
+            if constexpr (is_memcpy_source_v<T, ForwardIt>) {
+                if (n > 0) {
+                    std::memcpy(dest, first, n * sizeof(T));
+                }
+                return first + n;
+            } else {
+                std::size_t i = 0;
+                try {
+                    for (; i < n; ++i, ++first) {
+                        construct(dest + i, *first);
+                    }
+                } catch (...) {
+                    destroy_contiguous(dest, i);
+                    throw;
+                }
+                return first;
+            }
+        }
+
+        void destroy_contiguous(T* items, std::size_t n) noexcept {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    destroy(items + i);
+                }
+            }
+        }
+
+        /**
+         * Implements resize(). `construct_item` constructs an element at
+         * the given address.
+         */
+        template <typename Func>
+        void resize_with(std::size_t n, Func&& construct_item) {
+            if (n <= size()) {
+                pop_back_n(size() - n);
+                return;
+            }
+            reserve_additional(n - size());
+            auto [first, second] = segments(end(), begin() + n);
+            for (span<T> segment : {first, second}) {
+                T* item = segment.data();
+                for (T* last = item + segment.size(); item != last; ++item) {
+                    construct_item(item);
+                    ++m_size;
+                }
+            }
+        }
+
+        /**
+         * Destroys the `n` elements starting at index `i`, one contiguous
+         * segment at a time.
+         */
+        void destroy_range(std::size_t i, std::size_t n) noexcept {
+            auto [first, second] = segments(begin() + i, begin() + i + n);
+            destroy_contiguous(first.data(), first.size());
+            destroy_contiguous(second.data(), second.size());
+        }
+
         /* allocation */
         /* ========== */
 
+        /**
+         * Allocates a buffer for `size` elements. For sizes up to
+         * `inline_capacity`, returns the inline buffer, whose capacity is
+         * always `inline_capacity`.
+         */
         AllocPtr allocate(std::size_t size) {
+            if constexpr (inline_capacity > 0) {
+                if (size <= inline_capacity) {
+                    assert(size == inline_capacity);
+                    return inline_alloc_ptr();
+                }
+            }
             if (size == 0) {
                 return nullptr;
             }
-            return AllocTraits::allocate(allocator(), size);
+            AllocPtr memory = AllocTraits::allocate(allocator(), size);
+            record_allocation(size);
+            return memory;
+        }
+
+        /**
+         * Updates statistics, if enabled, after a buffer for `size`
+         * elements was allocated or reallocated.
+         */
+        void record_allocation([[maybe_unused]] std::size_t size) noexcept {
+            #if CXXUTIL_ARRAY_DEQUE_STATS
+                ArrayDequeStats delta;
+                delta.allocations = 1;
+                delta.bytes_allocated = size * sizeof(T);
+                delta.peak_capacity = size;
+                array_deque_stats::record(m_stats, delta);
+            #endif
         }
 
         void deallocate(AllocPtr memory, std::size_t size) noexcept {
+            if constexpr (inline_capacity > 0) {
+                if (memory == inline_alloc_ptr()) {
+                    return;
+                }
+            }
             if (memory) {
                 AllocTraits::deallocate(allocator(), memory, size);
             }
         }
 
         template <typename... Args>
-        void construct(AllocPtr obj, Args&&... args) {
+        void construct(T* obj, Args&&... args) {
             AllocTraits::construct(
                 allocator(), obj, std::forward<Args>(args)...
             );
         }
 
-        void destroy(AllocPtr obj) noexcept {
+        void destroy(T* obj) noexcept {
             AllocTraits::destroy(allocator(), obj);
         }
 
         /* ========== */
 
         std::size_t mod_capacity(std::size_t value) const noexcept {
-            return value & (capacity() - 1);
+            return Policy::wrap(value, capacity());
         }
 
         T* buffer_ptr() const noexcept {
@@ -707,29 +2113,136 @@ namespace utility::detail::array_deque {
             return buffer_ptr(mod_capacity(m_head + i));
         }
 
+        /**
+         * Gets the number of elements stored contiguously starting at
+         * `m_head`. The remaining elements, if any, wrap around to the
+         * start of the buffer.
+         */
+        std::size_t head_segment_size() const noexcept {
+            return std::min(size(), capacity() - m_head);
+        }
+
+        AllocPtr inline_alloc_ptr() const noexcept {
+            return std::pointer_traits<AllocPtr>::pointer_to(
+                *this->inline_buffer()
+            );
+        }
+
+        bool is_inline() const noexcept {
+            if constexpr (inline_capacity > 0) {
+                return buffer_ptr() == this->inline_buffer();
+            } else {
+                return false;
+            }
+        }
+
+        /**
+         * Sets the deque to its initial, empty state without destroying
+         * elements or deallocating memory.
+         */
         void reset() noexcept {
             m_capacity = 0;
             m_head = 0;
             m_size = 0;
             m_buffer = nullptr;
+            if constexpr (inline_capacity > 0) {
+                m_capacity = inline_capacity;
+                m_buffer = inline_alloc_ptr();
+            }
         }
 
-        void destroy() noexcept {
-            for (std::size_t i = 0; i < size(); ++i) {
-                destroy(buffer_ptr(i));
+        /**
+         * Destroys all elements but keeps the buffer.
+         */
+        void destroy_items() noexcept {
+            if constexpr (std::is_trivially_destructible_v<T>) {
+                m_size = 0;
+            } else {
+                for (; m_size > 0; --m_size) {
+                    destroy(item_ptr(m_size - 1));
+                }
             }
+        }
+
+        void destroy() noexcept {
+            auto [first, second] = as_spans();
+            destroy_contiguous(first.data(), first.size());
+            destroy_contiguous(second.data(), second.size());
             deallocate(m_buffer, capacity());
         }
+
+        #if CXXUTIL_ARRAY_DEQUE_STATS
+            ArrayDequeStats m_stats;
+        #endif
     };
 }
 
 namespace utility {
     /**
-     * template <typename T, typename Allocator = std::allocator<T>>
+     * template <
+     *     typename T,
+     *     typename Allocator = std::allocator<T>,
+     *     std::size_t inline_capacity = 0,
+     *     typename CapacityPolicy = Pow2Capacity
+     * >
      * class ArrayDeque;
      *
      * A deque (double-ended queue) implemented as a dynamically resizing
-     * array.
+     * array. `CapacityPolicy` decides which capacities are allowed and how
+     * the buffer grows.
      */
     using detail::array_deque::ArrayDeque;
+
+    /**
+     * The default ArrayDeque capacity policy: capacities are powers of 2.
+     */
+    using detail::array_deque::Pow2Capacity;
+
+    /**
+     * template <std::size_t num = 3, std::size_t den = 2>
+     * struct ExactCapacity;
+     *
+     * An ArrayDeque capacity policy that allows any capacity and grows by
+     * a factor of `num / den`, trading a little speed per access for less
+     * wasted memory.
+     */
+    using detail::array_deque::ExactCapacity;
+
+    /**
+     * template <typename Policy = Pow2Capacity, std::size_t den = 4>
+     * struct AutoShrink;
+     *
+     * An ArrayDeque capacity policy that behaves like `Policy`, but also
+     * halves the capacity when elements are popped and the deque is less
+     * than 1/`den` full.
+     */
+    using detail::array_deque::AutoShrink;
+
+    /**
+     * An ArrayDeque that stores up to `N` elements (which must be a power
+     * of 2) in an inline buffer, and allocates memory only when more
+     * elements are needed.
+     */
+    template <
+        typename T,
+        ::std::size_t N,
+        typename Allocator = ::std::allocator<T>
+    >
+    using SmallArrayDeque = detail::array_deque::ArrayDeque<T, Allocator, N>;
+
+    /**
+     * Segmented versions of standard algorithms for ArrayDeque iterators.
+     * Each range is split where it wraps around the end of the buffer, and
+     * the standard algorithm is run on each contiguous part. These are also
+     * found by argument-dependent lookup when called unqualified.
+     */
+    using detail::array_deque::segments;
+    using detail::array_deque::find;
+    using detail::array_deque::find_if;
+    using detail::array_deque::for_each;
+    using detail::array_deque::fill;
+    using detail::array_deque::accumulate;
+    using detail::array_deque::copy;
+    using detail::array_deque::equal;
+    using detail::array_deque::lexicographical_compare;
 }
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <thread>
+
+namespace utility {
+    /**
+     * Waits between attempts of a busy-wait loop: the first calls return
+     * immediately, and later calls yield to other threads.
+     */
+    class Backoff {
+        public:
+        void operator()() noexcept {
+            if (m_spins < max_spins) {
+                ++m_spins;
+            } else {
+                ::std::this_thread::yield();
+            }
+        }
+
+        void reset() noexcept {
+            m_spins = 0;
+        }
+
+        bool spinning() const noexcept {
+            return m_spins < max_spins;
+        }
+
+        private:
+        static constexpr unsigned max_spins = 64;
+        unsigned m_spins = 0;
+    };
+}
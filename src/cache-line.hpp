@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+
+namespace utility {
+    /**
+     * The assumed size of a cache line. Data written by different threads
+     * is aligned to this to avoid false sharing.
+     */
+    inline constexpr ::std::size_t cache_line_size = 64;
+}
@@ -0,0 +1,569 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "array-deque.hpp"
+#include "pow2.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace utility::detail::chunked_deque {
+    namespace std = ::std;
+
+    using ::utility::ArrayDeque;
+    using ::utility::pow2_ceil;
+    using ::utility::pow2_floor;
+
+    /**
+     * Default number of elements per block: about 4 KiB worth, but at
+     * least 16.
+     */
+    template <typename T>
+    inline constexpr std::size_t default_block_size = pow2_floor(
+        std::max<std::size_t>(4096 / sizeof(T), 16)
+    );
+
+    template <typename T, typename Allocator, std::size_t block_size>
+    class ChunkedDeque;
+
+    /**
+     * Iterators store a pointer to the deque and the logical index of an
+     * element.
+     */
+    template <typename Deque, typename T>
+    class Iterator {
+        using Self = Iterator;
+
+        public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::remove_const_t<T>;
+        using reference = T&;
+        using pointer = T*;
+        using iterator_category = std::random_access_iterator_tag;
+
+        Iterator() noexcept = default;
+
+        template <
+            typename D,
+            typename = std::enable_if_t<std::is_const_v<Deque>, D>
+        >
+        Iterator(const Iterator<D, value_type>& other) noexcept :
+        m_deque(other.m_deque), m_index(other.m_index) {
+        }
+
+        pointer operator->() const noexcept {
+            return &(*m_deque)[m_index];
+        }
+
+        reference operator*() const noexcept {
+            return (*m_deque)[m_index];
+        }
+
+        reference operator[](difference_type i) const noexcept {
+            return *(*this + i);
+        }
+
+        bool operator==(const Self& other) const noexcept {
+            return m_index == other.m_index;
+        }
+
+        bool operator!=(const Self& other) const noexcept {
+            return !(*this == other);
+        }
+
+        bool operator<(const Self& other) const noexcept {
+            return m_index < other.m_index;
+        }
+
+        bool operator>(const Self& other) const noexcept {
+            return other < *this;
+        }
+
+        bool operator<=(const Self& other) const noexcept {
+            return !(*this > other);
+        }
+
+        bool operator>=(const Self& other) const noexcept {
+            return other <= *this;
+        }
+
+        Self& operator+=(difference_type n) noexcept {
+            m_index += n;
+            return *this;
+        }
+
+        Self& operator-=(difference_type n) noexcept {
+            m_index -= n;
+            return *this;
+        }
+
+        Self& operator++() noexcept {
+            return *this += 1;
+        }
+
+        Self& operator--() noexcept {
+            return *this -= 1;
+        }
+
+        Self operator++(int) noexcept {
+            Self result(*this);
+            ++*this;
+            return result;
+        }
+
+        Self operator--(int) noexcept {
+            Self result(*this);
+            --*this;
+            return result;
+        }
+
+        Self operator+(difference_type n) const noexcept {
+            Self result(*this);
+            result += n;
+            return result;
+        }
+
+        friend Self operator+(difference_type n, const Self& self) noexcept {
+            return self + n;
+        }
+
+        Self operator-(difference_type n) const noexcept {
+            Self result(*this);
+            result -= n;
+            return result;
+        }
+
+        difference_type operator-(const Self& other) const noexcept {
+            return (
+                static_cast<difference_type>(m_index) -
+                static_cast<difference_type>(other.m_index)
+            );
+        }
+
+        private:
+        template <typename, typename>
+        friend class Iterator;
+
+        template <typename, typename, std::size_t>
+        friend class ChunkedDeque;
+
+        Iterator(Deque* deque, std::size_t i) noexcept :
+        m_deque(deque), m_index(i) {
+        }
+
+        Deque* m_deque = nullptr;
+        std::size_t m_index = 0;
+    };
+
+    template <
+        typename T,
+        typename Allocator = std::allocator<T>,
+        std::size_t block_size = default_block_size<T>
+    >
+    class ChunkedDeque;
+
+    template <typename T, typename Allocator, std::size_t block_size>
+    class ChunkedDeque : Allocator {
+        using Self = ChunkedDeque;
+        using AllocTraits = std::allocator_traits<Allocator>;
+        using BlockAllocator = typename AllocTraits::template rebind_alloc<
+            T*
+        >;
+
+        static_assert(
+            block_size > 0 && pow2_ceil(block_size) == block_size,
+            "block size must be a power of 2"
+        );
+
+        static_assert(
+            std::is_same_v<typename AllocTraits::pointer, T*>,
+            "allocator must use plain pointers"
+        );
+
+        public:
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using iterator = Iterator<Self, T>;
+        using const_iterator = Iterator<const Self, const T>;
+        using difference_type = std::ptrdiff_t;
+        using size_type = std::size_t;
+
+        ChunkedDeque() noexcept(noexcept(Allocator())) :
+        ChunkedDeque(Allocator()) {
+        }
+
+        explicit ChunkedDeque(const Allocator& alloc) noexcept :
+        Allocator(alloc), m_blocks(BlockAllocator(alloc)) {
+        }
+
+        template <typename InputIt>
+        ChunkedDeque(
+            InputIt first, InputIt last, const Allocator& alloc = Allocator()
+        ) : Self(alloc) {
+            append(first, last);
+        }
+
+        ChunkedDeque(
+            std::initializer_list<T> list,
+            const Allocator& alloc = Allocator()
+        ) : Self(list.begin(), list.end(), alloc) {
+        }
+
+        ChunkedDeque(const Self& other) : Self(
+            other.begin(), other.end(),
+            AllocTraits::select_on_container_copy_construction(
+                other.allocator()
+            )
+        ) {
+        }
+
+        ChunkedDeque(Self&& other) noexcept :
+        Allocator(std::move(other.allocator())),
+        m_blocks(std::move(other.m_blocks)),
+        m_offset(std::exchange(other.m_offset, 0)),
+        m_size(std::exchange(other.m_size, 0)) {
+        }
+
+        ~ChunkedDeque() {
+            clear();
+        }
+
+        /**
+         * Copy-and-swap assignment. The allocator is always propagated.
+         */
+        Self& operator=(Self other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        void swap(Self& other) noexcept {
+            using std::swap;
+            swap(allocator(), other.allocator());
+            swap(m_blocks, other.m_blocks);
+            swap(m_offset, other.m_offset);
+            swap(m_size, other.m_size);
+        }
+
+        friend void swap(Self& first, Self& second) noexcept {
+            first.swap(second);
+        }
+
+        bool operator==(const Self& other) const {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+
+        bool operator!=(const Self& other) const {
+            return !(*this == other);
+        }
+
+        /* size/capacity observers */
+        /* ======================= */
+
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /* element accessors */
+        /* ================= */
+
+        const T& operator[](std::size_t i) const noexcept {
+            return *item_ptr(i);
+        }
+
+        T& operator[](std::size_t i) noexcept {
+            return *item_ptr(i);
+        }
+
+        const T& at(std::size_t i) const {
+            if (i >= size()) {
+                throw std::out_of_range("ChunkedDeque::at(): bad index");
+            }
+            return (*this)[i];
+        }
+
+        T& at(std::size_t i) {
+            return const_cast<T&>(static_cast<const Self&>(*this).at(i));
+        }
+
+        const T& front() const noexcept {
+            return (*this)[0];
+        }
+
+        T& front() noexcept {
+            return (*this)[0];
+        }
+
+        const T& back() const noexcept {
+            return (*this)[size() - 1];
+        }
+
+        T& back() noexcept {
+            return (*this)[size() - 1];
+        }
+
+        /* modifiers */
+        /* ========= */
+
+        void push_front(const T& obj) {
+            emplace_front(obj);
+        }
+
+        void push_front(T&& obj) {
+            emplace_front(std::move(obj));
+        }
+
+        void push_back(const T& obj) {
+            emplace_back(obj);
+        }
+
+        void push_back(T&& obj) {
+            emplace_back(std::move(obj));
+        }
+
+        /**
+         * Inserts an element at the front. Existing elements are never
+         * moved, so pointers and references to them stay valid.
+         */
+        template <typename... Args>
+        T& emplace_front(Args&&... args) {
+            bool added = m_offset == 0;
+            if (added) {
+                add_block_front();
+            }
+            try {
+                construct(
+                    item_ptr_at(m_offset - 1), std::forward<Args>(args)...
+                );
+            } catch (...) {
+                if (added) {
+                    remove_block_front();
+                }
+                throw;
+            }
+            --m_offset;
+            ++m_size;
+            return front();
+        }
+
+        /**
+         * Inserts an element at the back. Existing elements are never
+         * moved, so pointers and references to them stay valid.
+         */
+        template <typename... Args>
+        T& emplace_back(Args&&... args) {
+            std::size_t end = m_offset + m_size;
+            bool added = end == m_blocks.size() * block_size;
+            if (added) {
+                add_block_back();
+            }
+            try {
+                construct(item_ptr_at(end), std::forward<Args>(args)...);
+            } catch (...) {
+                if (added) {
+                    remove_block_back();
+                }
+                throw;
+            }
+            ++m_size;
+            return back();
+        }
+
+        template <typename InputIt>
+        void append(InputIt first, InputIt last) {
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+
+        /**
+         * Removes the first element. Its block is freed once it's empty.
+         */
+        void pop_front() noexcept {
+            assert(!empty());
+            destroy(item_ptr(0));
+            ++m_offset;
+            --m_size;
+            if (m_offset == block_size) {
+                remove_block_front();
+            }
+        }
+
+        /**
+         * Removes the last element. Its block is freed once it's empty.
+         */
+        void pop_back() noexcept {
+            assert(!empty());
+            --m_size;
+            std::size_t end = m_offset + m_size;
+            destroy(item_ptr_at(end));
+            if (end == (m_blocks.size() - 1) * block_size) {
+                remove_block_back();
+            }
+        }
+
+        void clear() noexcept {
+            while (!empty()) {
+                pop_back();
+            }
+            while (!m_blocks.empty()) {
+                remove_block_back();
+            }
+            m_offset = 0;
+        }
+
+        /* iteration */
+        /* ========= */
+
+        const_iterator begin() const noexcept {
+            return {this, 0};
+        }
+
+        iterator begin() noexcept {
+            return {this, 0};
+        }
+
+        const_iterator end() const noexcept {
+            return {this, size()};
+        }
+
+        iterator end() noexcept {
+            return {this, size()};
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+        /* private members */
+        /* =============== */
+
+        private:
+        static constexpr std::size_t block_shift = [] {
+            std::size_t shift = 0;
+            while ((std::size_t(1) << shift) < block_size) {
+                ++shift;
+            }
+            return shift;
+        }();
+
+        const Allocator& allocator() const noexcept {
+            return *this;
+        }
+
+        Allocator& allocator() noexcept {
+            return *this;
+        }
+
+        /**
+         * Gets a pointer to the slot at position `i` from the start of the
+         * first block.
+         */
+        T* item_ptr_at(std::size_t i) const noexcept {
+            return m_blocks[i >> block_shift] + (i & (block_size - 1));
+        }
+
+        T* item_ptr(std::size_t i) const noexcept {
+            return item_ptr_at(m_offset + i);
+        }
+
+        void add_block_front() {
+            T* block = AllocTraits::allocate(allocator(), block_size);
+            try {
+                m_blocks.push_front(block);
+            } catch (...) {
+                AllocTraits::deallocate(allocator(), block, block_size);
+                throw;
+            }
+            m_offset += block_size;
+        }
+
+        void add_block_back() {
+            T* block = AllocTraits::allocate(allocator(), block_size);
+            try {
+                m_blocks.push_back(block);
+            } catch (...) {
+                AllocTraits::deallocate(allocator(), block, block_size);
+                throw;
+            }
+        }
+
+        void remove_block_front() noexcept {
+            AllocTraits::deallocate(allocator(), m_blocks.front(), block_size);
+            m_blocks.pop_front();
+            m_offset -= block_size;
+        }
+
+        void remove_block_back() noexcept {
+            AllocTraits::deallocate(allocator(), m_blocks.back(), block_size);
+            m_blocks.pop_back();
+        }
+
+        template <typename... Args>
+        void construct(T* obj, Args&&... args) {
+            AllocTraits::construct(
+                allocator(), obj, std::forward<Args>(args)...
+            );
+        }
+
+        void destroy(T* obj) noexcept {
+            AllocTraits::destroy(allocator(), obj);
+        }
+
+        // Pointers to the blocks, in order. Elements occupy positions
+        // [m_offset, m_offset + m_size) counted from the start of the
+        // first block.
+        ArrayDeque<T*, BlockAllocator> m_blocks;
+        std::size_t m_offset = 0;
+        std::size_t m_size = 0;
+    };
+}
+
+namespace utility {
+    /**
+     * template <
+     *     typename T,
+     *     typename Allocator = std::allocator<T>,
+     *     std::size_t block_size = (about 4 KiB of elements)
+     * >
+     * class ChunkedDeque;
+     *
+     * A deque that stores its elements in fixed-size blocks (of a power of
+     * 2 elements), tracked by an ArrayDeque of block pointers. Elements are
+     * never moved after they're inserted, so pointers and references to
+     * them stay valid until they're removed. Indexing is O(1): a shift
+     * and a mask.
+     */
+    using detail::chunked_deque::ChunkedDeque;
+}
@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "span.hpp"
+#include "throw-errno.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace utility::detail::mirrored_ring_buffer {
+    namespace std = ::std;
+
+    using ::utility::span;
+    using ::utility::throw_errno;
+
+    /**
+     * Maps a shared memory object of `bytes` bytes (a multiple of the page
+     * size) twice, back to back, and returns the address of the first
+     * mapping.
+     */
+    inline unsigned char* map_mirrored(std::size_t bytes) {
+        int fd = ::memfd_create("MirroredRingBuffer", MFD_CLOEXEC);
+        if (fd < 0) {
+            throw_errno("MirroredRingBuffer: memfd_create");
+        }
+        if (::ftruncate(fd, static_cast<::off_t>(bytes)) != 0) {
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            throw_errno("MirroredRingBuffer: ftruncate");
+        }
+        // Reserve the address range for both copies first, then replace
+        // each half with a view of the same memory.
+        void* base = ::mmap(
+            nullptr, bytes * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+        );
+        bool mapped = base != MAP_FAILED;
+        auto* bytes_base = static_cast<unsigned char*>(base);
+        for (std::size_t i = 0; mapped && i < 2; ++i) {
+            void* half = ::mmap(
+                bytes_base + bytes * i, bytes, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_FIXED, fd, 0
+            );
+            mapped = half != MAP_FAILED;
+        }
+        int error = errno;
+        // The mappings keep the memory alive.
+        ::close(fd);
+        if (!mapped) {
+            if (base != MAP_FAILED) {
+                ::munmap(base, bytes * 2);
+            }
+            errno = error;
+            throw_errno("MirroredRingBuffer: mmap");
+        }
+        return bytes_base;
+    }
+
+    template <typename T>
+    class MirroredRingBuffer {
+        using Self = MirroredRingBuffer;
+
+        static_assert(
+            std::is_trivially_copyable_v<T>,
+            "MirroredRingBuffer requires trivially copyable elements"
+        );
+
+        public:
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = std::size_t;
+
+        /**
+         * Creates a ring buffer that holds at least `capacity` elements
+         * (and at least 1). The capacity is rounded up so that the buffer
+         * is a whole number of pages. The buffer is never resized.
+         */
+        explicit MirroredRingBuffer(std::size_t capacity) {
+            auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            std::size_t unit = page_size / std::gcd(page_size, sizeof(T));
+            capacity = std::max<std::size_t>(capacity, 1);
+            if (capacity > std::size_t(-1) / 2 / sizeof(T) - unit) {
+                throw std::runtime_error(
+                    "MirroredRingBuffer: capacity overflow"
+                );
+            }
+            m_capacity = (capacity + unit - 1) / unit * unit;
+            m_buffer = map_mirrored(m_capacity * sizeof(T));
+        }
+
+        MirroredRingBuffer(const Self&) = delete;
+
+        MirroredRingBuffer(Self&& other) noexcept :
+        m_buffer(std::exchange(other.m_buffer, nullptr)),
+        m_capacity(std::exchange(other.m_capacity, 0)),
+        m_head(std::exchange(other.m_head, 0)),
+        m_size(std::exchange(other.m_size, 0)) {
+        }
+
+        ~MirroredRingBuffer() {
+            if (m_buffer) {
+                ::munmap(m_buffer, m_capacity * sizeof(T) * 2);
+            }
+        }
+
+        Self& operator=(Self other) noexcept {
+            swap(*this, other);
+            return *this;
+        }
+
+        friend void swap(Self& first, Self& second) noexcept {
+            using std::swap;
+            swap(first.m_buffer, second.m_buffer);
+            swap(first.m_capacity, second.m_capacity);
+            swap(first.m_head, second.m_head);
+            swap(first.m_size, second.m_size);
+        }
+
+        /* size/capacity observers */
+        /* ======================= */
+
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        std::size_t capacity() const noexcept {
+            return m_capacity;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        bool full() const noexcept {
+            return size() == capacity();
+        }
+
+        /* element accessors */
+        /* ================= */
+
+        /**
+         * Gets a pointer to the first element. The elements always occupy
+         * the contiguous range [data(), data() + size()), even when they
+         * wrap around the end of the buffer.
+         */
+        const T* data() const noexcept {
+            return items() + m_head;
+        }
+
+        T* data() noexcept {
+            return items() + m_head;
+        }
+
+        const T& operator[](std::size_t i) const noexcept {
+            return data()[i];
+        }
+
+        T& operator[](std::size_t i) noexcept {
+            return data()[i];
+        }
+
+        const T& at(std::size_t i) const {
+            if (i >= size()) {
+                throw std::out_of_range("MirroredRingBuffer::at(): bad index");
+            }
+            return (*this)[i];
+        }
+
+        T& at(std::size_t i) {
+            return const_cast<T&>(static_cast<const Self&>(*this).at(i));
+        }
+
+        const T& front() const noexcept {
+            return (*this)[0];
+        }
+
+        T& front() noexcept {
+            return (*this)[0];
+        }
+
+        const T& back() const noexcept {
+            return (*this)[size() - 1];
+        }
+
+        T& back() noexcept {
+            return (*this)[size() - 1];
+        }
+
+        /* modifiers */
+        /* ========= */
+
+        /**
+         * Inserts an element at the back. The buffer must not be full.
+         */
+        void push_back(const T& item) noexcept {
+            assert(!full());
+            std::memcpy(static_cast<void*>(data() + size()), &item, sizeof(T));
+            ++m_size;
+        }
+
+        /**
+         * Inserts an element at the front. The buffer must not be full.
+         */
+        void push_front(const T& item) noexcept {
+            assert(!full());
+            m_head = m_head == 0 ? capacity() - 1 : m_head - 1;
+            std::memcpy(static_cast<void*>(data()), &item, sizeof(T));
+            ++m_size;
+        }
+
+        /**
+         * Inserts `n` elements at the back with a single copy. There must
+         * be room for them.
+         */
+        void append(const T* items, std::size_t n) noexcept {
+            assert(n <= capacity() - size());
+            if (n > 0) {
+                std::memcpy(
+                    static_cast<void*>(data() + size()), items, n * sizeof(T)
+                );
+            }
+            m_size += n;
+        }
+
+        void pop_front() noexcept {
+            pop_front_n(1);
+        }
+
+        void pop_back() noexcept {
+            assert(!empty());
+            --m_size;
+        }
+
+        /**
+         * Removes the first `n` elements, which must not be more than the
+         * size.
+         */
+        void pop_front_n(std::size_t n) noexcept {
+            assert(n <= size());
+            m_head += n;
+            m_head -= m_head >= capacity() ? capacity() : 0;
+            m_size -= n;
+        }
+
+        void clear() noexcept {
+            m_head = 0;
+            m_size = 0;
+        }
+
+        /* contiguous views */
+        /* ================ */
+
+        span<const T> as_span() const noexcept {
+            return {data(), size()};
+        }
+
+        span<T> as_span() noexcept {
+            return {data(), size()};
+        }
+
+        /**
+         * Gets the unoccupied slots after the last element as a single
+         * contiguous range. Elements written to these slots can be added
+         * to the buffer with commit_back().
+         */
+        span<T> free_span() noexcept {
+            return {data() + size(), capacity() - size()};
+        }
+
+        /**
+         * Adds the first `n` elements written to the range returned by
+         * free_span() to the back of the buffer.
+         */
+        void commit_back(std::size_t n) noexcept {
+            assert(n <= capacity() - size());
+            m_size += n;
+        }
+
+        private:
+        T* items() const noexcept {
+            return reinterpret_cast<T*>(m_buffer);
+        }
+
+        unsigned char* m_buffer = nullptr;
+        std::size_t m_capacity = 0;
+        std::size_t m_head = 0;
+        std::size_t m_size = 0;
+    };
+}
+
+namespace utility {
+    /**
+     * A fixed-capacity ring buffer of trivially copyable elements whose
+     * memory is mapped twice in a row, so that the elements (and the free
+     * space after them) are always contiguous, without any index
+     * wrapping. Requires Linux (memfd_create()).
+     */
+    using detail::mirrored_ring_buffer::MirroredRingBuffer;
+}
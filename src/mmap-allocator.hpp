@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <sys/mman.h>
+
+namespace utility::detail::mmap_allocator {
+    namespace std = ::std;
+
+    /**
+     * Allocations of at least this many bytes are mapped directly with
+     * mmap() (2 MiB, the size of a transparent huge page on x86-64).
+     */
+    inline constexpr std::size_t mmap_threshold = std::size_t(1) << 21;
+
+    inline void* map(std::size_t bytes) {
+        void* memory = ::mmap(
+            nullptr, bytes, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+        );
+        if (memory == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        #ifdef MADV_HUGEPAGE
+            // Only a hint; failure just means regular pages are used.
+            ::madvise(memory, bytes, MADV_HUGEPAGE);
+        #endif
+        return memory;
+    }
+
+    inline void unmap(void* memory, std::size_t bytes) noexcept {
+        ::munmap(memory, bytes);
+    }
+
+    /**
+     * Resizes a mapping. Where possible, the mapping is extended in place
+     * or its pages are moved without copying.
+     */
+    inline void* remap(
+        void* memory, std::size_t old_bytes, std::size_t bytes
+    ) {
+        #ifdef MREMAP_MAYMOVE
+            void* result = ::mremap(memory, old_bytes, bytes, MREMAP_MAYMOVE);
+            if (result == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            #ifdef MADV_HUGEPAGE
+                if (bytes > old_bytes) {
+                    ::madvise(result, bytes, MADV_HUGEPAGE);
+                }
+            #endif
+            return result;
+        #else
+            void* result = map(bytes);
+            std::memcpy(result, memory, std::min(old_bytes, bytes));
+            unmap(memory, old_bytes);
+            return result;
+        #endif
+    }
+
+    template <typename T>
+    class MmapAllocator {
+        static_assert(
+            alignof(T) <= alignof(std::max_align_t),
+            "over-aligned types are not supported"
+        );
+
+        public:
+        using value_type = T;
+
+        MmapAllocator() noexcept = default;
+
+        template <typename U>
+        MmapAllocator(const MmapAllocator<U>&) noexcept {
+        }
+
+        T* allocate(std::size_t n) {
+            if (n > std::size_t(-1) / sizeof(T)) {
+                throw std::bad_alloc();
+            }
+            std::size_t bytes = n * sizeof(T);
+            if (bytes >= mmap_threshold) {
+                return static_cast<T*>(map(bytes));
+            }
+            void* memory = std::malloc(bytes);
+            if (!memory) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(memory);
+        }
+
+        void deallocate(T* memory, std::size_t n) noexcept {
+            std::size_t bytes = n * sizeof(T);
+            if (bytes >= mmap_threshold) {
+                unmap(memory, bytes);
+            } else {
+                std::free(memory);
+            }
+        }
+
+        /**
+         * Resizes an allocation of `old_n` objects to `n` objects, keeping
+         * the bytes of the first min(`old_n`, `n`) objects. The memory may
+         * move, so this is only suitable for trivially relocatable types.
+         * On failure, std::bad_alloc is thrown and `memory` is unchanged.
+         */
+        T* reallocate(T* memory, std::size_t old_n, std::size_t n) {
+            if (n > std::size_t(-1) / sizeof(T)) {
+                throw std::bad_alloc();
+            }
+            std::size_t old_bytes = old_n * sizeof(T);
+            std::size_t bytes = n * sizeof(T);
+            bool old_mapped = old_bytes >= mmap_threshold;
+            bool mapped = bytes >= mmap_threshold;
+            if (old_mapped && mapped) {
+                return static_cast<T*>(remap(memory, old_bytes, bytes));
+            }
+            if (!old_mapped && !mapped) {
+                void* result = std::realloc(memory, bytes);
+                if (!result) {
+                    throw std::bad_alloc();
+                }
+                return static_cast<T*>(result);
+            }
+            T* result = allocate(n);
+            std::memcpy(
+                static_cast<void*>(result), static_cast<void*>(memory),
+                std::min(old_bytes, bytes)
+            );
+            deallocate(memory, old_n);
+            return result;
+        }
+
+        template <typename U>
+        bool operator==(const MmapAllocator<U>&) const noexcept {
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=(const MmapAllocator<U>&) const noexcept {
+            return false;
+        }
+    };
+}
+
+namespace utility {
+    /**
+     * An allocator for very large buffers. Small allocations use
+     * std::malloc(); large ones are mapped with mmap() and marked for
+     * transparent huge pages. It also provides `reallocate()`, which
+     * ArrayDeque uses for trivially relocatable types to grow large
+     * buffers in place with mremap() instead of copying them.
+     */
+    using detail::mmap_allocator::MmapAllocator;
+}
@@ -0,0 +1,427 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "backoff.hpp"
+#include "cache-line.hpp"
+#include "pow2.hpp"
+#include "storage-for.hpp"
+#include "to-address.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace utility::detail::mpmc_queue {
+    namespace std = ::std;
+
+    using ::utility::Backoff;
+    using ::utility::cache_line_size;
+    using ::utility::pow2_ceil;
+    using ::utility::StorageFor;
+    using ::utility::to_address;
+
+    template <typename T>
+    struct Slot {
+        std::atomic<std::size_t> m_sequence;
+        StorageFor<T> m_storage;
+
+        explicit Slot(std::size_t sequence) noexcept : m_sequence(sequence) {
+        }
+
+        T* item() noexcept {
+            return std::launder(reinterpret_cast<T*>(&m_storage));
+        }
+
+        void* storage() noexcept {
+            return &m_storage;
+        }
+    };
+
+    template <typename T, typename Allocator = std::allocator<T>>
+    class MpmcQueue : Allocator {
+        using Self = MpmcQueue;
+        using AllocTraits = std::allocator_traits<Allocator>;
+        using SlotAlloc = typename AllocTraits::template rebind_alloc<
+            Slot<T>
+        >;
+        using SlotAllocTraits = std::allocator_traits<SlotAlloc>;
+        using SlotPtr = typename SlotAllocTraits::pointer;
+
+        static_assert(
+            std::is_nothrow_move_constructible_v<T> &&
+            std::is_nothrow_move_assignable_v<T>,
+            "MpmcQueue requires types with non-throwing moves"
+        );
+
+        public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        /**
+         * Creates a queue that holds `capacity` elements, rounded up to a
+         * power of 2 (and at least 2).
+         */
+        explicit MpmcQueue(
+            std::size_t capacity, const Allocator& alloc = Allocator()
+        ) : Allocator(alloc) {
+            m_capacity = pow2_ceil(std::max<std::size_t>(capacity, 2));
+            SlotAlloc slot_alloc(allocator());
+            m_slots = SlotAllocTraits::allocate(slot_alloc, m_capacity);
+            for (std::size_t i = 0; i < m_capacity; ++i) {
+                SlotAllocTraits::construct(slot_alloc, slot_ptr(i), i);
+            }
+        }
+
+        MpmcQueue(const Self&) = delete;
+        Self& operator=(const Self&) = delete;
+
+        ~MpmcQueue() {
+            std::size_t head = m_dequeue_pos.load(std::memory_order_relaxed);
+            std::size_t tail = m_enqueue_pos.load(std::memory_order_relaxed);
+            for (; head != tail; ++head) {
+                AllocTraits::destroy(allocator(), slot(head).item());
+            }
+            SlotAlloc slot_alloc(allocator());
+            for (std::size_t i = 0; i < m_capacity; ++i) {
+                SlotAllocTraits::destroy(slot_alloc, slot_ptr(i));
+            }
+            SlotAllocTraits::deallocate(slot_alloc, m_slots, m_capacity);
+        }
+
+        std::size_t capacity() const noexcept {
+            return m_capacity;
+        }
+
+        /**
+         * Gets the number of elements in the queue, which may be out of
+         * date by the time it is used.
+         */
+        std::size_t size_approx() const noexcept {
+            std::size_t tail = m_enqueue_pos.load(std::memory_order_acquire);
+            std::size_t head = m_dequeue_pos.load(std::memory_order_acquire);
+            return tail - std::min(head, tail);
+        }
+
+        /* non-blocking operations */
+        /* ======================= */
+
+        /**
+         * Inserts an element at the back of the queue, unless the queue is
+         * full. Returns whether the element was inserted.
+         */
+        bool try_push(const T& obj) {
+            if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+                return try_emplace_nothrow(obj);
+            } else {
+                return try_emplace_nothrow(T(obj));
+            }
+        }
+
+        bool try_push(T&& obj) noexcept {
+            return try_emplace_nothrow(std::move(obj));
+        }
+
+        /**
+         * Constructs an element at the back of the queue, unless the queue
+         * is full. If the element can't be constructed from `args` without
+         * throwing, it is constructed before checking whether the queue is
+         * full.
+         */
+        template <typename... Args>
+        bool try_emplace(Args&&... args) {
+            if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+                return try_emplace_nothrow(std::forward<Args>(args)...);
+            } else {
+                return try_emplace_nothrow(T(std::forward<Args>(args)...));
+            }
+        }
+
+        /**
+         * Removes the first element and move-assigns it to `out`, unless
+         * the queue is empty. Returns whether an element was removed.
+         */
+        bool try_pop(T& out) noexcept {
+            std::size_t pos;
+            if (claim(m_dequeue_pos, 1, 1, pos) == 0) {
+                return false;
+            }
+            T* item = slot(pos).item();
+            out = std::move(*item);
+            release_popped(pos, item);
+            return true;
+        }
+
+        /**
+         * Inserts copies of up to `n` elements from the range starting at
+         * `first`, stopping when the queue is full, and returns the number
+         * of elements inserted. When elements can be copied without
+         * throwing, all of the slots are claimed at once.
+         */
+        template <typename InputIt>
+        std::size_t try_push_n(InputIt first, std::size_t n) {
+            return push_some(first, n);
+        }
+
+        /**
+         * Removes up to `n` elements from the front of the queue and
+         * move-assigns them to the range starting at `out`, and returns the
+         * number of elements removed. All of the slots are claimed at once.
+         * If assigning to `out` throws, the remaining claimed elements are
+         * discarded.
+         */
+        template <typename OutputIt>
+        std::size_t try_pop_n(OutputIt out, std::size_t n) {
+            return pop_some(out, n);
+        }
+
+        /* blocking operations */
+        /* =================== */
+
+        /**
+         * Inserts an element at the back of the queue, waiting (by
+         * spinning and then yielding) until there is room.
+         */
+        void push(const T& obj) {
+            if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+                for (Backoff backoff; !try_emplace_nothrow(obj);) {
+                    backoff();
+                }
+            } else {
+                push(T(obj));
+            }
+        }
+
+        void push(T&& obj) noexcept {
+            for (Backoff backoff; !try_emplace_nothrow(std::move(obj));) {
+                backoff();
+            }
+        }
+
+        template <typename... Args>
+        void emplace(Args&&... args) {
+            if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+                for (Backoff backoff; !try_emplace_nothrow(
+                    std::forward<Args>(args)...
+                );) {
+                    backoff();
+                }
+            } else {
+                push(T(std::forward<Args>(args)...));
+            }
+        }
+
+        /**
+         * Removes and returns the first element, waiting (by spinning and
+         * then yielding) until the queue is not empty.
+         */
+        T pop() noexcept {
+            std::size_t pos;
+            for (Backoff backoff; claim(m_dequeue_pos, 1, 1, pos) == 0;) {
+                backoff();
+            }
+            T* item = slot(pos).item();
+            T result(std::move(*item));
+            release_popped(pos, item);
+            return result;
+        }
+
+        /**
+         * Inserts copies of the `n` elements in the range starting at
+         * `first`, waiting until there is room for each batch.
+         */
+        template <typename InputIt>
+        void push_n(InputIt first, std::size_t n) {
+            for (Backoff backoff; n > 0;) {
+                std::size_t pushed = push_some(first, n);
+                if (pushed == 0) {
+                    backoff();
+                }
+                n -= pushed;
+            }
+        }
+
+        /**
+         * Removes `n` elements and move-assigns them to the range starting
+         * at `out`, waiting until enough elements are available.
+         */
+        template <typename OutputIt>
+        OutputIt pop_n(OutputIt out, std::size_t n) {
+            for (Backoff backoff; n > 0;) {
+                std::size_t popped = pop_some(out, n);
+                if (popped == 0) {
+                    backoff();
+                }
+                n -= popped;
+            }
+            return out;
+        }
+
+        private:
+        /**
+         * Implements try_push_n(), advancing `first` past the elements
+         * inserted.
+         */
+        template <typename InputIt>
+        std::size_t push_some(InputIt& first, std::size_t n) {
+            using Ref = typename std::iterator_traits<InputIt>::reference;
+            if constexpr (!std::is_nothrow_constructible_v<T, Ref>) {
+                std::size_t i = 0;
+                for (; i < n && try_emplace(*first); ++i, ++first) {
+                }
+                return i;
+            } else {
+                std::size_t pos;
+                n = claim(m_enqueue_pos, 0, n, pos);
+                for (std::size_t i = 0; i < n; ++i, ++first) {
+                    Slot<T>& s = slot(pos + i);
+                    AllocTraits::construct(allocator(), s.item(), *first);
+                    s.m_sequence.store(pos + i + 1, std::memory_order_release);
+                }
+                return n;
+            }
+        }
+
+        /**
+         * Implements try_pop_n(), advancing `out` past the elements
+         * assigned.
+         */
+        template <typename OutputIt>
+        std::size_t pop_some(OutputIt& out, std::size_t n) {
+            std::size_t pos;
+            n = claim(m_dequeue_pos, 1, n, pos);
+            std::size_t i = 0;
+            try {
+                for (; i < n; ++i, ++out) {
+                    T* item = slot(pos + i).item();
+                    *out = std::move(*item);
+                    release_popped(pos + i, item);
+                }
+            } catch (...) {
+                for (; i < n; ++i) {
+                    release_popped(pos + i, slot(pos + i).item());
+                }
+                throw;
+            }
+            return n;
+        }
+
+        const Allocator& allocator() const noexcept {
+            return *this;
+        }
+
+        Allocator& allocator() noexcept {
+            return *this;
+        }
+
+        Slot<T>* slot_ptr(std::size_t i) const noexcept {
+            return to_address(m_slots) + i;
+        }
+
+        Slot<T>& slot(std::size_t pos) const noexcept {
+            return *slot_ptr(pos & (m_capacity - 1));
+        }
+
+        /**
+         * Claims up to `n` consecutive slots starting at `counter` whose
+         * sequence numbers are their positions plus `offset` (0 for slots
+         * ready to be filled, 1 for slots ready to be emptied). Stores the
+         * first position in `pos` and returns the number of slots claimed,
+         * which is 0 if the queue is full (or empty, respectively).
+         */
+        std::size_t claim(
+            std::atomic<std::size_t>& counter, std::size_t offset,
+            std::size_t n, std::size_t& pos
+        ) noexcept {
+            pos = counter.load(std::memory_order_relaxed);
+            while (n > 0) {
+                std::size_t k = 0;
+                std::size_t sequence = 0;
+                for (; k < n; ++k) {
+                    sequence = slot(pos + k).m_sequence.load(
+                        std::memory_order_acquire
+                    );
+                    if (sequence != pos + k + offset) {
+                        break;
+                    }
+                }
+                if (k > 0) {
+                    if (counter.compare_exchange_weak(
+                        pos, pos + k, std::memory_order_relaxed
+                    )) {
+                        return k;
+                    }
+                    continue;
+                }
+                auto diff = static_cast<std::ptrdiff_t>(
+                    sequence - (pos + offset)
+                );
+                if (diff < 0) {
+                    return 0;
+                }
+                pos = counter.load(std::memory_order_relaxed);
+            }
+            return 0;
+        }
+
+        template <typename... Args>
+        bool try_emplace_nothrow(Args&&... args) noexcept {
+            std::size_t pos;
+            if (claim(m_enqueue_pos, 0, 1, pos) == 0) {
+                return false;
+            }
+            Slot<T>& s = slot(pos);
+            AllocTraits::construct(
+                allocator(), s.item(), std::forward<Args>(args)...
+            );
+            s.m_sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        void release_popped(std::size_t pos, T* item) noexcept {
+            AllocTraits::destroy(allocator(), item);
+            slot(pos).m_sequence.store(
+                pos + m_capacity, std::memory_order_release
+            );
+        }
+
+        SlotPtr m_slots = nullptr;
+        std::size_t m_capacity = 0;
+        alignas(cache_line_size) std::atomic<std::size_t> m_enqueue_pos {0};
+        alignas(cache_line_size) std::atomic<std::size_t> m_dequeue_pos {0};
+    };
+}
+
+namespace utility {
+    /**
+     * template <typename T, typename Allocator = std::allocator<T>>
+     * class MpmcQueue;
+     *
+     * A bounded, lock-free multi-producer/multi-consumer queue (Dmitry
+     * Vyukov's design). Each slot in the power-of-2 ring has a sequence
+     * number that tells producers and consumers whether it is ready to be
+     * filled or emptied; indices are masked as in ArrayDeque. Batch
+     * operations claim several slots with a single compare-and-swap.
+     */
+    using detail::mpmc_queue::MpmcQueue;
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "array-deque.hpp"
+#include "span.hpp"
+#include "thread-pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace utility::detail::parallel_algorithms {
+    namespace std = ::std;
+
+    using ::utility::span;
+    using ::utility::TaskGroup;
+    using ::utility::ThreadPool;
+    using ::utility::detail::array_deque::Iterator;
+    using ::utility::detail::array_deque::segments;
+
+    // Ranges with fewer elements than this are processed on the calling
+    // thread.
+    inline constexpr std::size_t serial_threshold = 1 << 14;
+
+    // Chunks are at least this large, so each task does enough work to
+    // outweigh its scheduling cost.
+    inline constexpr std::size_t min_chunk_bytes = 1 << 16;
+
+    // Chunks are at most this large, so each one fits in a typical L2
+    // cache. Larger ranges are split into more chunks instead.
+    inline constexpr std::size_t max_chunk_bytes = 1 << 18;
+
+    template <typename T>
+    std::size_t chunk_size(const ThreadPool& pool, std::size_t n) noexcept {
+        std::size_t min_size = std::max<std::size_t>(
+            min_chunk_bytes / sizeof(T), 1
+        );
+        std::size_t max_size = std::max<std::size_t>(
+            max_chunk_bytes / sizeof(T), 1
+        );
+        // A few chunks per thread, so stealing can balance the load.
+        std::size_t chunks = pool.size() * 4;
+        return std::clamp((n + chunks - 1) / chunks, min_size, max_size);
+    }
+
+    /**
+     * Calls `func(items, offset)` for consecutive contiguous chunks of
+     * [first, last), where `offset` is the position of `items` in the
+     * range. The chunks never cross the point where the elements wrap
+     * around the end of the buffer. They're processed in parallel on
+     * `pool`, unless the range is shorter than `serial_threshold`.
+     */
+    template <typename T, typename Func>
+    void run_chunks(
+        ThreadPool& pool, Iterator<T> first, Iterator<T> last, Func&& func
+    ) {
+        auto n = static_cast<std::size_t>(last - first);
+        auto [head, tail] = segments(first, last);
+        if (n < serial_threshold) {
+            func(head, std::size_t(0));
+            if (!tail.empty()) {
+                func(tail, head.size());
+            }
+            return;
+        }
+        std::size_t size = chunk_size<T>(pool, n);
+        TaskGroup group(pool);
+        std::size_t offset = 0;
+        for (span<T> segment : {head, tail}) {
+            for (std::size_t i = 0; i < segment.size(); i += size) {
+                std::size_t len = std::min(size, segment.size() - i);
+                span<T> chunk = segment.subspan(i).first(len);
+                group.run([&func, chunk, chunk_offset = offset + i] {
+                    func(chunk, chunk_offset);
+                });
+            }
+            offset += segment.size();
+        }
+        group.wait();
+    }
+
+    /**
+     * Calls `func` on each element in [first, last), in parallel. `func`
+     * may be called concurrently from multiple threads.
+     */
+    template <typename T, typename Func>
+    void for_each(
+        ThreadPool& pool, Iterator<T> first, Iterator<T> last, Func func
+    ) {
+        run_chunks(pool, first, last, [&](span<T> items, std::size_t) {
+            std::for_each(items.begin(), items.end(), func);
+        });
+    }
+
+    /**
+     * Stores `op(x)` for each element `x` in [first, last) in the range
+     * starting at `out`, which must be a random-access iterator, in
+     * parallel. Returns the end of the output range.
+     */
+    template <typename T, typename OutputIt, typename UnaryOp>
+    OutputIt transform(
+        ThreadPool& pool,
+        Iterator<T> first,
+        Iterator<T> last,
+        OutputIt out,
+        UnaryOp op
+    ) {
+        run_chunks(pool, first, last, [&](span<T> items, std::size_t i) {
+            std::transform(items.begin(), items.end(), out + i, op);
+        });
+        return out + (last - first);
+    }
+
+    /**
+     * Copies [first, last) to the range starting at `out`, which must be
+     * a random-access iterator, in parallel. Returns the end of the output
+     * range.
+     */
+    template <typename T, typename OutputIt>
+    OutputIt copy(
+        ThreadPool& pool, Iterator<T> first, Iterator<T> last, OutputIt out
+    ) {
+        run_chunks(pool, first, last, [&](span<T> items, std::size_t i) {
+            std::copy(items.begin(), items.end(), out + i);
+        });
+        return out + (last - first);
+    }
+
+    /**
+     * Combines `init` and the elements in [first, last) with `op`, in
+     * parallel. `op` must be associative. Partial results are combined in
+     * order, so it need not be commutative.
+     */
+    template <
+        typename T,
+        typename Value,
+        typename BinaryOp = std::plus<>
+    >
+    Value reduce(
+        ThreadPool& pool,
+        Iterator<T> first,
+        Iterator<T> last,
+        Value init,
+        BinaryOp op = BinaryOp()
+    ) {
+        std::vector<std::pair<std::size_t, Value>> partials;
+        std::mutex mutex;
+        run_chunks(pool, first, last, [&](span<T> items, std::size_t i) {
+            if (items.empty()) {
+                return;
+            }
+            Value partial = std::accumulate(
+                items.begin() + 1, items.end(), Value(items[0]), op
+            );
+            std::lock_guard lock(mutex);
+            partials.emplace_back(i, std::move(partial));
+        });
+        std::sort(
+            partials.begin(), partials.end(),
+            [](const auto& a, const auto& b) {
+                return a.first < b.first;
+            }
+        );
+        for (auto& partial : partials) {
+            init = op(std::move(init), std::move(partial.second));
+        }
+        return init;
+    }
+
+    /**
+     * Sorts [first, last) in parallel: each chunk is sorted with
+     * std::sort(), then pairs of adjacent sorted runs are merged in
+     * parallel until one run remains.
+     */
+    template <typename T, typename Compare = std::less<>>
+    void sort(
+        ThreadPool& pool,
+        Iterator<T> first,
+        Iterator<T> last,
+        Compare comp = Compare()
+    ) {
+        auto n = static_cast<std::size_t>(last - first);
+        if (n < serial_threshold) {
+            std::sort(first, last, comp);
+            return;
+        }
+        // Start offsets of the sorted runs, followed by `n`.
+        std::vector<std::size_t> bounds;
+        std::mutex mutex;
+        run_chunks(pool, first, last, [&](span<T> items, std::size_t i) {
+            std::sort(items.begin(), items.end(), comp);
+            std::lock_guard lock(mutex);
+            bounds.push_back(i);
+        });
+        std::sort(bounds.begin(), bounds.end());
+        bounds.push_back(n);
+        while (bounds.size() > 2) {
+            TaskGroup group(pool);
+            std::vector<std::size_t> merged;
+            for (std::size_t i = 0; i < bounds.size(); i += 2) {
+                merged.push_back(bounds[i]);
+                if (i + 2 >= bounds.size()) {
+                    continue;
+                }
+                auto a = first + bounds[i];
+                auto b = first + bounds[i + 1];
+                auto c = first + bounds[i + 2];
+                group.run([a, b, c, &comp] {
+                    std::inplace_merge(a, b, c, comp);
+                });
+            }
+            if (bounds.size() % 2 == 0) {
+                merged.push_back(n);
+            }
+            group.wait();
+            bounds = std::move(merged);
+        }
+    }
+}
+
+namespace utility {
+    /**
+     * Parallel versions of standard algorithms for ArrayDeque iterators,
+     * run on a ThreadPool passed as the first argument. The range is split
+     * where it wraps around the end of the buffer, and each part is cut
+     * into chunks that run as separate tasks. Short ranges are processed
+     * serially on the calling thread.
+     */
+    using detail::parallel_algorithms::for_each;
+    using detail::parallel_algorithms::transform;
+    using detail::parallel_algorithms::copy;
+    using detail::parallel_algorithms::reduce;
+    using detail::parallel_algorithms::sort;
+}
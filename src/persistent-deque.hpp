@@ -0,0 +1,436 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "pow2.hpp"
+#include "span.hpp"
+#include "throw-errno.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utility::detail::persistent_deque {
+    namespace std = ::std;
+
+    using ::utility::pow2_ceil;
+    using ::utility::span;
+    using ::utility::throw_errno;
+
+    /**
+     * Stored at the start of the file. The elements follow at offset
+     * `header_size`.
+     */
+    struct Header {
+        std::uint64_t m_magic;
+        std::uint64_t m_item_size;
+        std::uint64_t m_capacity;
+        std::uint64_t m_head;
+        std::uint64_t m_size;
+    };
+
+    // "cxxdequ1" when read as little-endian bytes.
+    inline constexpr std::uint64_t magic = 0x3175716564787863;
+    inline constexpr std::size_t header_size = 64;
+
+    [[noreturn]] inline void throw_bad_file() {
+        throw std::runtime_error("PersistentDeque: invalid file");
+    }
+
+    template <typename T>
+    class PersistentDeque {
+        using Self = PersistentDeque;
+
+        static_assert(
+            std::is_trivially_copyable_v<T>,
+            "PersistentDeque requires trivially copyable elements"
+        );
+
+        static_assert(
+            alignof(T) <= header_size,
+            "element alignment is too large"
+        );
+
+        public:
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = std::size_t;
+
+        /**
+         * Opens the deque stored in the file at `path`, creating the file
+         * if it doesn't exist or is empty. Opening an existing deque only
+         * maps the file; its elements aren't read.
+         */
+        explicit PersistentDeque(const char* path) {
+            m_fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (m_fd < 0) {
+                throw_errno("PersistentDeque: open");
+            }
+            try {
+                init();
+            } catch (...) {
+                close();
+                throw;
+            }
+        }
+
+        PersistentDeque(const Self&) = delete;
+
+        PersistentDeque(Self&& other) noexcept :
+        m_fd(std::exchange(other.m_fd, -1)),
+        m_map(std::exchange(other.m_map, nullptr)),
+        m_map_size(std::exchange(other.m_map_size, 0)) {
+        }
+
+        ~PersistentDeque() {
+            close();
+        }
+
+        Self& operator=(Self other) noexcept {
+            swap(*this, other);
+            return *this;
+        }
+
+        friend void swap(Self& first, Self& second) noexcept {
+            using std::swap;
+            swap(first.m_fd, second.m_fd);
+            swap(first.m_map, second.m_map);
+            swap(first.m_map_size, second.m_map_size);
+        }
+
+        std::size_t size() const noexcept {
+            return header().m_size;
+        }
+
+        std::size_t capacity() const noexcept {
+            return header().m_capacity;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /* element accessors */
+        /* ================= */
+
+        const T& operator[](std::size_t i) const noexcept {
+            assert(i < size());
+            return *item_ptr(i);
+        }
+
+        T& operator[](std::size_t i) noexcept {
+            assert(i < size());
+            return *item_ptr(i);
+        }
+
+        const T& at(std::size_t i) const {
+            if (i >= size()) {
+                throw std::out_of_range("PersistentDeque::at(): bad index");
+            }
+            return (*this)[i];
+        }
+
+        T& at(std::size_t i) {
+            return const_cast<T&>(static_cast<const Self&>(*this).at(i));
+        }
+
+        const T& front() const noexcept {
+            return (*this)[0];
+        }
+
+        T& front() noexcept {
+            return (*this)[0];
+        }
+
+        const T& back() const noexcept {
+            return (*this)[size() - 1];
+        }
+
+        T& back() noexcept {
+            return (*this)[size() - 1];
+        }
+
+        /* modifiers */
+        /* ========= */
+
+        void push_back(const T& item) {
+            ensure_capacity();
+            std::memcpy(
+                static_cast<void*>(item_ptr(size())), &item, sizeof(T)
+            );
+            ++header().m_size;
+        }
+
+        void push_front(const T& item) {
+            ensure_capacity();
+            Header& h = header();
+            std::size_t head = mod_capacity(h.m_head - 1);
+            std::memcpy(static_cast<void*>(data() + head), &item, sizeof(T));
+            h.m_head = head;
+            ++h.m_size;
+        }
+
+        void pop_front() noexcept {
+            assert(!empty());
+            Header& h = header();
+            h.m_head = mod_capacity(h.m_head + 1);
+            --h.m_size;
+        }
+
+        void pop_back() noexcept {
+            assert(!empty());
+            --header().m_size;
+        }
+
+        /**
+         * Removes all elements. The file keeps its size.
+         */
+        void clear() noexcept {
+            header().m_head = 0;
+            header().m_size = 0;
+        }
+
+        /**
+         * Ensures that at least `capacity` elements fit without growing
+         * the file. Every growth flushes the whole file to disk (see
+         * flush()) so that it's crash-safe, which is slow for large files;
+         * reserving the expected capacity up front avoids repeating it at
+         * each doubling.
+         */
+        void reserve(std::size_t capacity) {
+            std::size_t new_capacity = pow2_ceil(capacity);
+            if (new_capacity < capacity) {
+                throw std::runtime_error("PersistentDeque: capacity overflow");
+            }
+            if (new_capacity > this->capacity()) {
+                grow(new_capacity);
+            }
+        }
+
+        /**
+         * Writes changes to the file, including its size, and waits for
+         * the write to finish. Without this, changes reach the file
+         * eventually, or when the deque is closed, but may be lost if the
+         * system crashes.
+         */
+        void flush() {
+            if (::msync(m_map, m_map_size, MS_SYNC) != 0) {
+                throw_errno("PersistentDeque: msync");
+            }
+            if (::fsync(m_fd) != 0) {
+                throw_errno("PersistentDeque: fsync");
+            }
+        }
+
+        /* contiguous views */
+        /* ================ */
+
+        /**
+         * Gets the elements as two contiguous ranges, like
+         * ArrayDeque::as_spans().
+         */
+        std::pair<span<const T>, span<const T>> as_spans() const noexcept {
+            std::size_t n = head_segment_size();
+            return {{item_ptr(0), n}, {data(), size() - n}};
+        }
+
+        std::pair<span<T>, span<T>> as_spans() noexcept {
+            std::size_t n = head_segment_size();
+            return {{item_ptr(0), n}, {data(), size() - n}};
+        }
+
+        private:
+        /**
+         * Initializes an empty file, or checks the header of an existing
+         * one, and maps it.
+         */
+        void init() {
+            struct ::stat st;
+            if (::fstat(m_fd, &st) != 0) {
+                throw_errno("PersistentDeque: fstat");
+            }
+            auto file_size = static_cast<std::size_t>(st.st_size);
+            if (file_size == 0) {
+                resize_file(header_size);
+                map(header_size);
+                header() = {magic, sizeof(T), 0, 0, 0};
+                return;
+            }
+            if (file_size < header_size) {
+                throw_bad_file();
+            }
+            map(file_size);
+            const Header& h = header();
+            bool valid = (
+                h.m_magic == magic &&
+                h.m_item_size == sizeof(T) &&
+                pow2_ceil(h.m_capacity) == h.m_capacity &&
+                h.m_capacity <= (file_size - header_size) / sizeof(T) &&
+                h.m_size <= h.m_capacity &&
+                (h.m_head < h.m_capacity || h.m_capacity == 0)
+            );
+            if (!valid) {
+                throw_bad_file();
+            }
+        }
+
+        void ensure_capacity() {
+            if (size() < capacity()) {
+                return;
+            }
+            std::size_t new_capacity = capacity() * 2;
+            if (new_capacity < capacity()) {
+                throw std::runtime_error("PersistentDeque: capacity overflow");
+            }
+            grow(new_capacity == 0 ? 1 : new_capacity);
+        }
+
+        /**
+         * Extends the file and the mapping, then copies the elements that
+         * wrapped around the end of the old buffer to just past its end, so
+         * that they follow the rest without moving the head. Elements are
+         * only copied, never overwritten, and the file is flushed before
+         * the new capacity is stored. That single aligned store commits
+         * the growth, so a crash at any point leaves either the old or the
+         * new contents intact. The flush costs an msync() of the whole
+         * mapping and an fsync() on every doubling.
+         */
+        void grow(std::size_t new_capacity) {
+            std::size_t max_capacity = (
+                (std::size_t(-1) - header_size) / sizeof(T)
+            );
+            if (new_capacity > max_capacity) {
+                throw std::runtime_error("PersistentDeque: capacity overflow");
+            }
+            std::size_t bytes = header_size + new_capacity * sizeof(T);
+            if (bytes > m_map_size) {
+                resize_file(bytes);
+                remap(bytes);
+            }
+            std::size_t old_capacity = capacity();
+            std::size_t back = size() - head_segment_size();
+            if (back > 0) {
+                T* items = data();
+                std::memcpy(
+                    static_cast<void*>(items + old_capacity), items,
+                    back * sizeof(T)
+                );
+            }
+            flush();
+            header().m_capacity = new_capacity;
+        }
+
+        void resize_file(std::size_t bytes) {
+            if (::ftruncate(m_fd, static_cast<::off_t>(bytes)) != 0) {
+                throw_errno("PersistentDeque: ftruncate");
+            }
+        }
+
+        void map(std::size_t bytes) {
+            void* memory = ::mmap(
+                nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0
+            );
+            if (memory == MAP_FAILED) {
+                throw_errno("PersistentDeque: mmap");
+            }
+            m_map = static_cast<unsigned char*>(memory);
+            m_map_size = bytes;
+        }
+
+        void remap(std::size_t bytes) {
+            #ifdef MREMAP_MAYMOVE
+                void* memory = ::mremap(
+                    m_map, m_map_size, bytes, MREMAP_MAYMOVE
+                );
+                if (memory == MAP_FAILED) {
+                    throw_errno("PersistentDeque: mremap");
+                }
+                m_map = static_cast<unsigned char*>(memory);
+                m_map_size = bytes;
+            #else
+                unsigned char* old_map = m_map;
+                std::size_t old_size = m_map_size;
+                map(bytes);
+                ::munmap(old_map, old_size);
+            #endif
+        }
+
+        void close() noexcept {
+            if (m_map) {
+                ::munmap(m_map, m_map_size);
+                m_map = nullptr;
+            }
+            if (m_fd >= 0) {
+                ::close(m_fd);
+                m_fd = -1;
+            }
+        }
+
+        const Header& header() const noexcept {
+            return *reinterpret_cast<const Header*>(m_map);
+        }
+
+        Header& header() noexcept {
+            return *reinterpret_cast<Header*>(m_map);
+        }
+
+        T* data() const noexcept {
+            return reinterpret_cast<T*>(m_map + header_size);
+        }
+
+        std::size_t mod_capacity(std::size_t value) const noexcept {
+            return value & (capacity() - 1);
+        }
+
+        T* item_ptr(std::size_t i) const noexcept {
+            return data() + mod_capacity(header().m_head + i);
+        }
+
+        std::size_t head_segment_size() const noexcept {
+            return std::min<std::size_t>(
+                size(), capacity() - header().m_head
+            );
+        }
+
+        int m_fd = -1;
+        unsigned char* m_map = nullptr;
+        std::size_t m_map_size = 0;
+    };
+}
+
+namespace utility {
+    /**
+     * A deque of trivially copyable elements stored in a memory-mapped
+     * file, so that its contents survive restarts. The header (capacity,
+     * head, and size) is kept in the file with the elements, and the file
+     * grows by doubling the capacity, like ArrayDeque. Each growth flushes
+     * the file, so reserve() ahead when the final size is known. Call
+     * `flush()` to make sure other changes are on disk.
+     */
+    using detail::persistent_deque::PersistentDeque;
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "array-deque.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace utility::detail::array_deque {
+    template <typename T, typename Allocator = std::allocator<T>>
+    class RingBuffer {
+        using Self = RingBuffer;
+        using Deque = ArrayDeque<T, Allocator>;
+
+        public:
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using iterator = typename Deque::iterator;
+        using const_iterator = typename Deque::const_iterator;
+        using difference_type = std::ptrdiff_t;
+        using size_type = std::size_t;
+
+        /**
+         * Creates a ring buffer that holds `capacity` elements, rounded up
+         * to a power of 2 (and at least 1). Its buffer is allocated once,
+         * here, and is never resized.
+         */
+        explicit RingBuffer(
+            std::size_t capacity, const Allocator& alloc = Allocator()
+        ) : m_deque(alloc) {
+            m_deque.reserve(std::max<std::size_t>(capacity, 1));
+        }
+
+        /* comparison operators */
+        /* ==================== */
+
+        bool operator==(const Self& other) const {
+            return m_deque == other.m_deque;
+        }
+
+        bool operator!=(const Self& other) const {
+            return m_deque != other.m_deque;
+        }
+
+        bool operator<(const Self& other) const {
+            return m_deque < other.m_deque;
+        }
+
+        bool operator>(const Self& other) const {
+            return m_deque > other.m_deque;
+        }
+
+        bool operator<=(const Self& other) const {
+            return m_deque <= other.m_deque;
+        }
+
+        bool operator>=(const Self& other) const {
+            return m_deque >= other.m_deque;
+        }
+
+        /* size/capacity observers */
+        /* ======================= */
+
+        std::size_t size() const noexcept {
+            return m_deque.size();
+        }
+
+        std::size_t capacity() const noexcept {
+            return m_deque.capacity();
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return m_deque.empty();
+        }
+
+        bool full() const noexcept {
+            return size() == capacity();
+        }
+
+        /* element accessors */
+        /* ================= */
+
+        const T& operator[](std::size_t i) const noexcept {
+            return m_deque[i];
+        }
+
+        T& operator[](std::size_t i) noexcept {
+            return m_deque[i];
+        }
+
+        const T& at(std::size_t i) const {
+            if (i >= size()) {
+                throw std::out_of_range("RingBuffer::at(): bad index");
+            }
+            return (*this)[i];
+        }
+
+        T& at(std::size_t i) {
+            return const_cast<T&>(static_cast<const Self&>(*this).at(i));
+        }
+
+        const T& front() const noexcept {
+            return m_deque.front();
+        }
+
+        T& front() noexcept {
+            return m_deque.front();
+        }
+
+        const T& back() const noexcept {
+            return m_deque.back();
+        }
+
+        T& back() noexcept {
+            return m_deque.back();
+        }
+
+        /* modifiers */
+        /* ========= */
+
+        /**
+         * Inserts an element at the back. The ring buffer must not be
+         * full.
+         */
+        void push_back(const T& obj) {
+            emplace_back(obj);
+        }
+
+        void push_back(T&& obj) {
+            emplace_back(std::move(obj));
+        }
+
+        template <typename... Args>
+        void emplace_back(Args&&... args) {
+            assert(!full());
+            m_deque.emplace_back_unchecked(std::forward<Args>(args)...);
+        }
+
+        /**
+         * Inserts an element at the back, removing the first element if
+         * the ring buffer is full. For trivial types, this doesn't branch
+         * on whether the buffer is full.
+         */
+        void push_back_overwrite(const T& obj) {
+            emplace_back_overwrite(obj);
+        }
+
+        void push_back_overwrite(T&& obj) {
+            emplace_back_overwrite(std::move(obj));
+        }
+
+        template <typename... Args>
+        void emplace_back_overwrite(Args&&... args) {
+            m_deque.emplace_back_overwrite(std::forward<Args>(args)...);
+        }
+
+        void pop_front() noexcept {
+            m_deque.pop_front();
+        }
+
+        void pop_back() noexcept {
+            m_deque.pop_back();
+        }
+
+        /**
+         * Destroys all elements. The buffer is kept.
+         */
+        void clear() noexcept {
+            m_deque.clear_keep_capacity();
+        }
+
+        /* contiguous views */
+        /* ================ */
+
+        std::pair<span<const T>, span<const T>> as_spans() const noexcept {
+            return m_deque.as_spans();
+        }
+
+        std::pair<span<T>, span<T>> as_spans() noexcept {
+            return m_deque.as_spans();
+        }
+
+        /* iteration */
+        /* ========= */
+
+        const_iterator begin() const noexcept {
+            return m_deque.begin();
+        }
+
+        iterator begin() noexcept {
+            return m_deque.begin();
+        }
+
+        const_iterator end() const noexcept {
+            return m_deque.end();
+        }
+
+        iterator end() noexcept {
+            return m_deque.end();
+        }
+
+        private:
+        Deque m_deque;
+    };
+}
+
+namespace utility {
+    /**
+     * template <typename T, typename Allocator = std::allocator<T>>
+     * class RingBuffer;
+     *
+     * A fixed-capacity ring buffer with the same layout as ArrayDeque. It
+     * never reallocates; push_back_overwrite() removes the oldest element
+     * when the buffer is full. A moved-from ring buffer has no capacity and
+     * may only be assigned to or destroyed.
+     */
+    using detail::array_deque::RingBuffer;
+}
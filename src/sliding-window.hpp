@@ -0,0 +1,444 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "array-deque.hpp"
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace utility::detail::sliding_window {
+    namespace std = ::std;
+
+    using ::utility::ArrayDeque;
+
+    /**
+     * An associative operation that returns the lesser of two values. A
+     * SlidingWindow using this operation keeps a monotonic deque instead
+     * of a full aggregation structure.
+     */
+    template <typename Compare = std::less<>>
+    class WindowMin {
+        public:
+        explicit WindowMin(const Compare& comp = Compare()) : m_comp(comp) {
+        }
+
+        template <typename T>
+        const T& operator()(const T& a, const T& b) const {
+            return m_comp(b, a) ? b : a;
+        }
+
+        /**
+         * Returns whether `a` must stay in the window's candidate list when
+         * `b` is pushed after it.
+         */
+        template <typename T>
+        bool keeps(const T& a, const T& b) const {
+            return m_comp(a, b);
+        }
+
+        private:
+        Compare m_comp;
+    };
+
+    /**
+     * An associative operation that returns the greater of two values. See
+     * WindowMin.
+     */
+    template <typename Compare = std::less<>>
+    class WindowMax {
+        public:
+        explicit WindowMax(const Compare& comp = Compare()) : m_comp(comp) {
+        }
+
+        template <typename T>
+        const T& operator()(const T& a, const T& b) const {
+            return m_comp(a, b) ? b : a;
+        }
+
+        template <typename T>
+        bool keeps(const T& a, const T& b) const {
+            return m_comp(b, a);
+        }
+
+        private:
+        Compare m_comp;
+    };
+
+    /**
+     * Two-stack aggregation for any associative operation. The front
+     * stack holds suffix aggregates of the oldest elements; the back
+     * stack is reduced to a single running aggregate of the newest ones.
+     * When the front stack runs out, it's rebuilt from every element in
+     * the window, which costs O(1) amortized per element.
+     */
+    template <typename T, typename Op, typename Allocator>
+    class TwoStacks {
+        public:
+        using Items = ArrayDeque<T, Allocator>;
+
+        TwoStacks(const Op& op, const Allocator& alloc) :
+        m_op(op), m_front(alloc) {
+        }
+
+        /**
+         * Called after `items.back()` was pushed.
+         */
+        void push(const Items& items) {
+            if (m_back) {
+                m_back = m_op(*m_back, items.back());
+            } else {
+                m_back = items.back();
+            }
+        }
+
+        /**
+         * Called before `items.front()` is popped.
+         */
+        void pop_front(const Items& items) {
+            if (m_front.empty()) {
+                flip(items);
+            }
+            m_front.pop_front();
+        }
+
+        void clear() noexcept {
+            m_front.clear_keep_capacity();
+            m_back.reset();
+        }
+
+        T value(const Items& items) const {
+            assert(!items.empty());
+            if (m_front.empty()) {
+                return *m_back;
+            }
+            if (!m_back) {
+                return m_front.front();
+            }
+            return m_op(m_front.front(), *m_back);
+        }
+
+        const Op& op() const noexcept {
+            return m_op;
+        }
+
+        private:
+        /**
+         * Rebuilds the front stack from every element. If `m_op` or a copy
+         * throws, the front stack is emptied again, so the aggregator is
+         * left as it was.
+         */
+        void flip(const Items& items) {
+            std::size_t i = items.size();
+            assert(i > 0 && m_front.empty());
+            m_front.reserve(i);
+            try {
+                m_front.push_front(items[--i]);
+                while (i > 0) {
+                    --i;
+                    m_front.push_front(m_op(items[i], m_front.front()));
+                }
+            } catch (...) {
+                m_front.clear_keep_capacity();
+                throw;
+            }
+            m_back.reset();
+        }
+
+        Op m_op;
+        // m_front[i] is the aggregate of items [i, m_front.size()).
+        ArrayDeque<T, Allocator> m_front;
+        // The aggregate of the remaining items, if there are any.
+        std::optional<T> m_back;
+    };
+
+    /**
+     * The classic monotonic deque for sliding-window minimums and
+     * maximums. It holds the positions of the elements that could still
+     * become the result, in order, with the result at the front.
+     */
+    template <typename T, typename Op, typename Allocator>
+    class Monotonic {
+        using IndexAllocator = typename std::allocator_traits<
+            Allocator
+        >::template rebind_alloc<std::size_t>;
+
+        public:
+        using Items = ArrayDeque<T, Allocator>;
+
+        Monotonic(const Op& op, const Allocator& alloc) :
+        m_op(op), m_indices(IndexAllocator(alloc)) {
+        }
+
+        void push(const Items& items) {
+            std::size_t last = items.size() - 1;
+            const T& obj = items[last];
+            // Reserve first so that the push below can't throw after
+            // candidates were removed.
+            m_indices.reserve(m_indices.size() + 1);
+            while (!m_indices.empty() && !m_op.keeps(
+                items[m_indices.back() - m_first], obj
+            )) {
+                m_indices.pop_back();
+            }
+            m_indices.push_back(m_first + last);
+        }
+
+        void pop_front(const Items&) noexcept {
+            if (m_indices.front() == m_first) {
+                m_indices.pop_front();
+            }
+            ++m_first;
+        }
+
+        void clear() noexcept {
+            m_indices.clear_keep_capacity();
+            m_first = 0;
+        }
+
+        const T& value(const Items& items) const noexcept {
+            assert(!items.empty());
+            return items[m_indices.front() - m_first];
+        }
+
+        const Op& op() const noexcept {
+            return m_op;
+        }
+
+        private:
+        Op m_op;
+        // Positions count every element ever pushed since the last clear;
+        // m_first is the position of the oldest element in the window.
+        ArrayDeque<std::size_t, IndexAllocator> m_indices;
+        std::size_t m_first = 0;
+    };
+
+    template <typename T, typename Op, typename Allocator>
+    struct AggregatorFor {
+        using type = TwoStacks<T, Op, Allocator>;
+    };
+
+    template <typename T, typename Compare, typename Allocator>
+    struct AggregatorFor<T, WindowMin<Compare>, Allocator> {
+        using type = Monotonic<T, WindowMin<Compare>, Allocator>;
+    };
+
+    template <typename T, typename Compare, typename Allocator>
+    struct AggregatorFor<T, WindowMax<Compare>, Allocator> {
+        using type = Monotonic<T, WindowMax<Compare>, Allocator>;
+    };
+
+    template <typename T, typename Op, typename Allocator = std::allocator<T>>
+    class SlidingWindow {
+        using Deque = ArrayDeque<T, Allocator>;
+        using Aggregator = typename AggregatorFor<T, Op, Allocator>::type;
+
+        public:
+        using value_type = T;
+        using const_reference = const T&;
+        using const_iterator = typename Deque::const_iterator;
+        using iterator = const_iterator;
+        using difference_type = std::ptrdiff_t;
+        using size_type = std::size_t;
+
+        /**
+         * Creates a window that holds at most `window_size` elements; once
+         * it's full, each push removes the oldest element. If
+         * `window_size` is 0, elements are removed only by pop_front().
+         */
+        explicit SlidingWindow(
+            std::size_t window_size = 0,
+            const Op& op = Op(),
+            const Allocator& alloc = Allocator()
+        ) : m_items(alloc), m_aggregator(op, alloc),
+        m_window_size(window_size) {
+            if (window_size > 0) {
+                m_items.reserve(window_size);
+            }
+        }
+
+        /* size/capacity observers */
+        /* ======================= */
+
+        std::size_t size() const noexcept {
+            return m_items.size();
+        }
+
+        std::size_t window_size() const noexcept {
+            return m_window_size;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return m_items.empty();
+        }
+
+        bool full() const noexcept {
+            return m_window_size > 0 && size() == m_window_size;
+        }
+
+        /* element accessors */
+        /* ================= */
+
+        const T& operator[](std::size_t i) const noexcept {
+            return m_items[i];
+        }
+
+        const T& front() const noexcept {
+            return m_items.front();
+        }
+
+        const T& back() const noexcept {
+            return m_items.back();
+        }
+
+        /**
+         * Returns the operation applied to every element in the window, in
+         * order. The window must not be empty. O(1) for WindowMin and
+         * WindowMax; one application of the operation otherwise.
+         */
+        T value() const {
+            return m_aggregator.value(m_items);
+        }
+
+        const Op& op() const noexcept {
+            return m_aggregator.op();
+        }
+
+        /* modifiers */
+        /* ========= */
+
+        /**
+         * Inserts an element at the back, removing the oldest element if
+         * the window is full. O(1) amortized.
+         */
+        void push(const T& obj) {
+            if (full()) {
+                pop_front();
+            }
+            push_unchecked(obj);
+        }
+
+        /**
+         * Pushes `n` elements starting at `first`. Elements that would be
+         * removed again before this returns are skipped without being
+         * copied, and the window's storage is reserved once.
+         */
+        template <typename InputIt>
+        void push_n(InputIt first, std::size_t n) {
+            if (m_window_size > 0) {
+                if (n >= m_window_size) {
+                    clear();
+                    skip(first, n - m_window_size);
+                    n = m_window_size;
+                } else {
+                    std::size_t total = size() + n;
+                    for (; total > m_window_size; --total) {
+                        pop_front();
+                    }
+                }
+            }
+            m_items.reserve(size() + n);
+            for (; n > 0; --n, ++first) {
+                push_unchecked(*first);
+            }
+        }
+
+        void pop_front() {
+            assert(!empty());
+            m_aggregator.pop_front(m_items);
+            m_items.pop_front();
+        }
+
+        /**
+         * Removes all elements. Storage is kept.
+         */
+        void clear() noexcept {
+            m_aggregator.clear();
+            m_items.clear_keep_capacity();
+        }
+
+        /* iteration */
+        /* ========= */
+
+        const_iterator begin() const noexcept {
+            return m_items.begin();
+        }
+
+        const_iterator end() const noexcept {
+            return m_items.end();
+        }
+
+        private:
+        void push_unchecked(const T& obj) {
+            m_items.push_back(obj);
+            try {
+                m_aggregator.push(m_items);
+            } catch (...) {
+                m_items.pop_back();
+                throw;
+            }
+        }
+
+        template <typename InputIt>
+        static void skip(InputIt& it, std::size_t n) {
+            using Diff = typename std::iterator_traits<
+                InputIt
+            >::difference_type;
+            std::advance(it, static_cast<Diff>(n));
+        }
+
+        Deque m_items;
+        Aggregator m_aggregator;
+        std::size_t m_window_size = 0;
+    };
+}
+
+namespace utility {
+    /**
+     * template <typename T, typename Op, typename Allocator>
+     * class SlidingWindow;
+     *
+     * A sliding window over a stream of values, stored in an ArrayDeque,
+     * that reports the aggregate of `Op` (an associative operation) over
+     * the elements it holds. Pushing and popping are O(1) amortized. With
+     * WindowMin or WindowMax, the window keeps a monotonic deque; any other
+     * operation uses two-stack aggregation.
+     */
+    using detail::sliding_window::SlidingWindow;
+
+    /**
+     * template <typename Compare = std::less<>>
+     * class WindowMin;
+     *
+     * Minimum operation for SlidingWindow.
+     */
+    using detail::sliding_window::WindowMin;
+
+    /**
+     * template <typename Compare = std::less<>>
+     * class WindowMax;
+     *
+     * Maximum operation for SlidingWindow.
+     */
+    using detail::sliding_window::WindowMax;
+}
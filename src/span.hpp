@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+#if __has_include(<span>)
+    #include <span>
+#endif
+
+namespace utility::detail::span {
+    namespace std = ::std;
+
+    /**
+     * Polyfill for C++20's std::span (dynamic extent only).
+     */
+    template <typename T>
+    class span {
+        public:
+        using element_type = T;
+        using pointer = T*;
+        using reference = T&;
+        using iterator = T*;
+        using size_type = std::size_t;
+
+        constexpr span() noexcept = default;
+
+        constexpr span(T* data, std::size_t size) noexcept :
+        m_data(data), m_size(size) {
+        }
+
+        template <
+            typename U,
+            typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>
+        >
+        constexpr span(const span<U>& other) noexcept :
+        m_data(other.data()), m_size(other.size()) {
+        }
+
+        constexpr T* data() const noexcept {
+            return m_data;
+        }
+
+        constexpr std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        constexpr std::size_t size_bytes() const noexcept {
+            return m_size * sizeof(T);
+        }
+
+        [[nodiscard]] constexpr bool empty() const noexcept {
+            return m_size == 0;
+        }
+
+        constexpr T& operator[](std::size_t i) const noexcept {
+            assert(i < m_size);
+            return m_data[i];
+        }
+
+        constexpr T* begin() const noexcept {
+            return m_data;
+        }
+
+        constexpr T* end() const noexcept {
+            return m_data + m_size;
+        }
+
+        constexpr span first(std::size_t n) const noexcept {
+            assert(n <= m_size);
+            return {m_data, n};
+        }
+
+        constexpr span subspan(std::size_t offset) const noexcept {
+            assert(offset <= m_size);
+            return {m_data + offset, m_size - offset};
+        }
+
+        private:
+        T* m_data = nullptr;
+        std::size_t m_size = 0;
+    };
+}
+
+namespace utility {
+    #if __cpp_lib_span
+        using ::std::span;
+    #else
+        using detail::span::span;
+    #endif
+}
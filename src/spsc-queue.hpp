@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "array-deque.hpp"
+#include "cache-line.hpp"
+#include "pow2.hpp"
+#include "span.hpp"
+#include "to-address.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace utility::detail::spsc_queue {
+    namespace std = ::std;
+
+    using ::utility::cache_line_size;
+    using ::utility::pow2_ceil;
+    using ::utility::span;
+    using ::utility::to_address;
+    using ::utility::detail::array_deque::is_memcpy_dest_v;
+    using ::utility::detail::array_deque::is_memcpy_source_v;
+
+    template <typename T, typename Allocator = std::allocator<T>>
+    class SpscQueue : Allocator {
+        using Self = SpscQueue;
+        using AllocTraits = std::allocator_traits<Allocator>;
+        using AllocPtr = typename AllocTraits::pointer;
+
+        public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        /**
+         * Creates a queue that holds `capacity` elements, rounded up to a
+         * power of 2 (and at least 1).
+         */
+        explicit SpscQueue(
+            std::size_t capacity, const Allocator& alloc = Allocator()
+        ) : Allocator(alloc) {
+            m_capacity = pow2_ceil(std::max<std::size_t>(capacity, 1));
+            m_buffer = AllocTraits::allocate(allocator(), m_capacity);
+        }
+
+        SpscQueue(const Self&) = delete;
+        Self& operator=(const Self&) = delete;
+
+        ~SpscQueue() {
+            std::size_t tail = load_tail(std::memory_order_relaxed);
+            std::size_t head = load_head(std::memory_order_relaxed);
+            for (; head != tail; ++head) {
+                AllocTraits::destroy(allocator(), item_ptr(head));
+            }
+            AllocTraits::deallocate(allocator(), m_buffer, m_capacity);
+        }
+
+        std::size_t capacity() const noexcept {
+            return m_capacity;
+        }
+
+        /**
+         * Gets the number of elements in the queue. The result may be out
+         * of date by the time it is used unless called from the producer or
+         * consumer thread while the other is idle.
+         */
+        std::size_t size_approx() const noexcept {
+            std::size_t head = load_head(std::memory_order_acquire);
+            std::size_t tail = load_tail(std::memory_order_acquire);
+            return tail - head;
+        }
+
+        [[nodiscard]] bool empty_approx() const noexcept {
+            return size_approx() == 0;
+        }
+
+        /* producer */
+        /* ======== */
+
+        /**
+         * Inserts an element at the back of the queue, unless the queue is
+         * full. Must be called only from the producer thread. Returns
+         * whether the element was inserted.
+         */
+        bool try_push(const T& obj) {
+            return try_emplace(obj);
+        }
+
+        bool try_push(T&& obj) {
+            return try_emplace(std::move(obj));
+        }
+
+        template <typename... Args>
+        bool try_emplace(Args&&... args) {
+            std::size_t tail = load_tail(std::memory_order_relaxed);
+            if (free_slots(tail) == 0) {
+                return false;
+            }
+            AllocTraits::construct(
+                allocator(), item_ptr(tail), std::forward<Args>(args)...
+            );
+            m_producer.m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Inserts copies of up to `n` elements from the range starting at
+         * `first`, stopping when the queue is full, and returns the number
+         * of elements inserted. The elements are published to the consumer
+         * all at once. Must be called only from the producer thread.
+         */
+        template <typename ForwardIt>
+        std::size_t try_push_n(ForwardIt first, std::size_t n) {
+            std::size_t tail = load_tail(std::memory_order_relaxed);
+            n = std::min(n, free_slots(tail, n));
+            auto [a, b] = slots(tail, n);
+            first = construct_contiguous(a, first);
+            try {
+                construct_contiguous(b, first);
+            } catch (...) {
+                destroy_contiguous(a);
+                throw;
+            }
+            m_producer.m_tail.store(tail + n, std::memory_order_release);
+            return n;
+        }
+
+        /* consumer */
+        /* ======== */
+
+        /**
+         * Removes the first element and move-assigns it to `out`, unless
+         * the queue is empty. Must be called only from the consumer thread.
+         * Returns whether an element was removed.
+         */
+        bool try_pop(T& out) {
+            return try_pop_n(&out, 1) == 1;
+        }
+
+        /**
+         * Gets a pointer to the first element, or null if the queue is
+         * empty. Must be called only from the consumer thread.
+         */
+        T* front() noexcept {
+            std::size_t head = load_head(std::memory_order_relaxed);
+            if (available(head) == 0) {
+                return nullptr;
+            }
+            return item_ptr(head);
+        }
+
+        /**
+         * Removes the first element. The queue must not be empty. Must be
+         * called only from the consumer thread.
+         */
+        void pop() noexcept {
+            std::size_t head = load_head(std::memory_order_relaxed);
+            AllocTraits::destroy(allocator(), item_ptr(head));
+            m_consumer.m_head.store(head + 1, std::memory_order_release);
+        }
+
+        /**
+         * Removes up to `n` elements from the front of the queue and
+         * move-assigns them to the range starting at `out`, and returns the
+         * number of elements removed. The slots are released to the
+         * producer all at once. Must be called only from the consumer
+         * thread.
+         */
+        template <typename OutputIt>
+        std::size_t try_pop_n(OutputIt out, std::size_t n) {
+            std::size_t head = load_head(std::memory_order_relaxed);
+            n = std::min(n, available(head, n));
+            if constexpr (is_memcpy_dest_v<T, OutputIt>) {
+                auto [a, b] = slots(head, n);
+                std::memcpy(out, a.data(), a.size_bytes());
+                std::memcpy(out + a.size(), b.data(), b.size_bytes());
+            } else {
+                std::size_t i = 0;
+                try {
+                    for (; i < n; ++i, ++out) {
+                        T* item = item_ptr(head + i);
+                        *out = std::move(*item);
+                        AllocTraits::destroy(allocator(), item);
+                    }
+                } catch (...) {
+                    m_consumer.m_head.store(
+                        head + i, std::memory_order_release
+                    );
+                    throw;
+                }
+            }
+            m_consumer.m_head.store(head + n, std::memory_order_release);
+            return n;
+        }
+
+        private:
+        const Allocator& allocator() const noexcept {
+            return *this;
+        }
+
+        Allocator& allocator() noexcept {
+            return *this;
+        }
+
+        std::size_t load_tail(std::memory_order order) const noexcept {
+            return m_producer.m_tail.load(order);
+        }
+
+        std::size_t load_head(std::memory_order order) const noexcept {
+            return m_consumer.m_head.load(order);
+        }
+
+        T* item_ptr(std::size_t i) const noexcept {
+            return to_address(m_buffer) + (i & (m_capacity - 1));
+        }
+
+        /**
+         * Gets the `n` slots starting at index `i` as two contiguous
+         * ranges.
+         */
+        std::pair<span<T>, span<T>> slots(
+            std::size_t i, std::size_t n
+        ) const noexcept {
+            T* first = item_ptr(i);
+            std::size_t n1 = std::min(
+                n, m_capacity - (i & (m_capacity - 1))
+            );
+            return {{first, n1}, {to_address(m_buffer), n - n1}};
+        }
+
+        /**
+         * Gets the number of free slots, as seen by the producer. The
+         * consumer's index is reloaded only if the cached copy shows fewer
+         * than `wanted` free slots.
+         */
+        std::size_t free_slots(
+            std::size_t tail, std::size_t wanted = 1
+        ) noexcept {
+            std::size_t free = m_capacity - (tail - m_producer.m_cached_head);
+            if (free < wanted) {
+                m_producer.m_cached_head = m_consumer.m_head.load(
+                    std::memory_order_acquire
+                );
+                free = m_capacity - (tail - m_producer.m_cached_head);
+            }
+            return free;
+        }
+
+        /**
+         * Gets the number of elements available, as seen by the consumer.
+         * The producer's index is reloaded only if the cached copy shows
+         * fewer than `wanted` elements.
+         */
+        std::size_t available(
+            std::size_t head, std::size_t wanted = 1
+        ) noexcept {
+            std::size_t count = m_consumer.m_cached_tail - head;
+            if (count < wanted) {
+                m_consumer.m_cached_tail = m_producer.m_tail.load(
+                    std::memory_order_acquire
+                );
+                count = m_consumer.m_cached_tail - head;
+            }
+            return count;
+        }
+
+        template <typename ForwardIt>
+        ForwardIt construct_contiguous(span<T> dest, ForwardIt first) {
+            if constexpr (is_memcpy_source_v<T, ForwardIt>) {
+                if (!dest.empty()) {
+                    std::memcpy(dest.data(), first, dest.size_bytes());
+                }
+                return first + dest.size();
+            } else {
+                std::size_t i = 0;
+                try {
+                    for (; i < dest.size(); ++i, ++first) {
+                        AllocTraits::construct(
+                            allocator(), dest.data() + i, *first
+                        );
+                    }
+                } catch (...) {
+                    destroy_contiguous(dest.first(i));
+                    throw;
+                }
+                return first;
+            }
+        }
+
+        void destroy_contiguous(span<T> items) noexcept {
+            for (T& item : items) {
+                AllocTraits::destroy(allocator(), &item);
+            }
+        }
+
+        AllocPtr m_buffer = nullptr;
+        std::size_t m_capacity = 0;
+
+        // Written only by the producer.
+        struct alignas(cache_line_size) {
+            std::atomic<std::size_t> m_tail {0};
+            std::size_t m_cached_head = 0;
+        } m_producer;
+
+        // Written only by the consumer.
+        struct alignas(cache_line_size) {
+            std::atomic<std::size_t> m_head {0};
+            std::size_t m_cached_tail = 0;
+        } m_consumer;
+    };
+}
+
+namespace utility {
+    /**
+     * template <typename T, typename Allocator = std::allocator<T>>
+     * class SpscQueue;
+     *
+     * A bounded, wait-free single-producer/single-consumer queue. Like
+     * ArrayDeque, it uses a power-of-2 ring buffer with masked indices.
+     * The producer and consumer indices are on separate cache lines, and
+     * each side keeps a cached copy of the other's index so it only
+     * touches the other cache line when the cached copy says the queue is
+     * full or empty.
+     */
+    using detail::spsc_queue::SpscQueue;
+}
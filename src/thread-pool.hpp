@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "array-deque.hpp"
+#include "backoff.hpp"
+#include "work-stealing-deque.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace utility::detail::thread_pool {
+    namespace std = ::std;
+
+    using ::utility::ArrayDeque;
+    using ::utility::Backoff;
+    using ::utility::WorkStealingDeque;
+
+    class ThreadPool;
+    class TaskGroup;
+
+    struct Task {
+        TaskGroup* m_group = nullptr;
+
+        virtual ~Task() = default;
+        virtual void run() = 0;
+    };
+
+    template <typename Func>
+    struct FuncTask final : Task {
+        Func m_func;
+
+        template <typename F>
+        explicit FuncTask(F&& func) : m_func(std::forward<F>(func)) {
+        }
+
+        void run() override {
+            m_func();
+        }
+    };
+
+    struct Worker {
+        ThreadPool* m_pool = nullptr;
+        std::size_t m_index = 0;
+        std::uint32_t m_rng = 0;
+        WorkStealingDeque<Task*> m_deque;
+
+        Worker(ThreadPool* pool, std::size_t index) noexcept :
+        m_pool(pool),
+        m_index(index),
+        m_rng(static_cast<std::uint32_t>(index) * 2654435761u + 1) {
+        }
+
+        /**
+         * Gets a pseudorandom number (xorshift32).
+         */
+        std::uint32_t random() noexcept {
+            m_rng ^= m_rng << 13;
+            m_rng ^= m_rng >> 17;
+            m_rng ^= m_rng << 5;
+            return m_rng;
+        }
+    };
+
+    // The worker running on the current thread, if any.
+    inline thread_local Worker* current_worker = nullptr;
+
+    class TaskGroup {
+        public:
+        explicit TaskGroup(ThreadPool& pool) noexcept : m_pool(pool) {
+        }
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        /**
+         * Waits for all tasks to finish. Exceptions from tasks that haven't
+         * been rethrown by wait() are discarded.
+         */
+        ~TaskGroup() {
+            wait_for_tasks();
+        }
+
+        /**
+         * Schedules `func()` to run on the pool. When called from a worker
+         * thread, the task goes on that worker's deque, where idle workers
+         * can steal it.
+         */
+        template <typename Func>
+        void run(Func&& func);
+
+        /**
+         * Waits for all tasks in the group to finish, running pending tasks
+         * on the current thread in the meantime. If any task threw an
+         * exception, the first one is rethrown.
+         */
+        void wait();
+
+        private:
+        friend ThreadPool;
+
+        void wait_for_tasks() noexcept;
+
+        void set_error(std::exception_ptr error) noexcept {
+            std::lock_guard lock(m_error_mutex);
+            if (!m_error) {
+                m_error = std::move(error);
+            }
+        }
+
+        ThreadPool& m_pool;
+        std::atomic<std::size_t> m_pending {0};
+        std::mutex m_error_mutex;
+        std::exception_ptr m_error;
+    };
+
+    class ThreadPool {
+        public:
+        /**
+         * Starts `threads` worker threads.
+         */
+        explicit ThreadPool(std::size_t threads = default_thread_count()) {
+            threads = std::max<std::size_t>(threads, 1);
+            m_workers.reserve(threads);
+            for (std::size_t i = 0; i < threads; ++i) {
+                m_workers.push_back(std::make_unique<Worker>(this, i));
+            }
+            try {
+                for (auto& worker : m_workers) {
+                    m_threads.emplace_back([this, &worker] {
+                        work(*worker);
+                    });
+                }
+            } catch (...) {
+                stop();
+                throw;
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * Stops the worker threads. All task groups must have finished.
+         */
+        ~ThreadPool() {
+            stop();
+        }
+
+        std::size_t size() const noexcept {
+            return m_workers.size();
+        }
+
+        static std::size_t default_thread_count() noexcept {
+            return std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        private:
+        friend TaskGroup;
+
+        // Number of times an idle worker looks for tasks before sleeping.
+        static constexpr unsigned idle_spins = 128;
+
+        Worker* local_worker() const noexcept {
+            Worker* worker = current_worker;
+            return worker && worker->m_pool == this ? worker : nullptr;
+        }
+
+        void submit(Task* task) {
+            m_queued.fetch_add(1);
+            try {
+                if (Worker* worker = local_worker()) {
+                    worker->m_deque.push(task);
+                } else {
+                    std::lock_guard lock(m_injection_mutex);
+                    m_injection.push_back(task);
+                }
+            } catch (...) {
+                m_queued.fetch_sub(1);
+                throw;
+            }
+            if (m_sleeping.load() > 0) {
+                std::lock_guard lock(m_sleep_mutex);
+                m_wake.notify_one();
+            }
+        }
+
+        /**
+         * Takes a task from `self`'s deque, the shared queue used by
+         * non-worker threads, or another worker's deque, in that order.
+         */
+        Task* find_task(Worker* self) noexcept {
+            if (m_queued.load(std::memory_order_relaxed) == 0) {
+                return nullptr;
+            }
+            if (self) {
+                if (auto task = self->m_deque.pop()) {
+                    return take(*task);
+                }
+            }
+            {
+                std::unique_lock lock(m_injection_mutex, std::try_to_lock);
+                if (lock && !m_injection.empty()) {
+                    Task* task = m_injection.front();
+                    m_injection.pop_front();
+                    return take(task);
+                }
+            }
+            std::size_t n = m_workers.size();
+            std::size_t start = self ? self->random() % n : 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                Worker& victim = *m_workers[(start + i) % n];
+                if (&victim == self) {
+                    continue;
+                }
+                if (auto task = victim.m_deque.steal()) {
+                    return take(*task);
+                }
+            }
+            return nullptr;
+        }
+
+        Task* take(Task* task) noexcept {
+            m_queued.fetch_sub(1);
+            return task;
+        }
+
+        static void run(Task* task) noexcept {
+            TaskGroup* group = task->m_group;
+            try {
+                task->run();
+            } catch (...) {
+                group->set_error(std::current_exception());
+            }
+            delete task;
+            // The group may be destroyed as soon as this is decremented.
+            group->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        void work(Worker& self) noexcept {
+            current_worker = &self;
+            unsigned spins = 0;
+            while (true) {
+                if (Task* task = find_task(&self)) {
+                    run(task);
+                    spins = 0;
+                    continue;
+                }
+                if (m_stop.load()) {
+                    break;
+                }
+                if (spins < idle_spins) {
+                    ++spins;
+                    std::this_thread::yield();
+                    continue;
+                }
+                // m_sleeping is incremented before m_queued is checked, so
+                // either this thread sees the new task or submit() sees
+                // this thread sleeping and wakes it.
+                m_sleeping.fetch_add(1);
+                {
+                    std::unique_lock lock(m_sleep_mutex);
+                    m_wake.wait(lock, [this] {
+                        return m_stop.load() || m_queued.load() > 0;
+                    });
+                }
+                m_sleeping.fetch_sub(1);
+                spins = 0;
+            }
+            current_worker = nullptr;
+        }
+
+        void stop() noexcept {
+            {
+                std::lock_guard lock(m_sleep_mutex);
+                m_stop.store(true);
+            }
+            m_wake.notify_all();
+            for (std::thread& thread : m_threads) {
+                thread.join();
+            }
+            m_threads.clear();
+        }
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_injection_mutex;
+        ArrayDeque<Task*> m_injection;
+
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wake;
+        std::atomic<std::size_t> m_queued {0};
+        std::atomic<std::size_t> m_sleeping {0};
+        std::atomic<bool> m_stop {false};
+    };
+
+    template <typename Func>
+    void TaskGroup::run(Func&& func) {
+        using TaskType = FuncTask<std::decay_t<Func>>;
+        auto task = std::make_unique<TaskType>(std::forward<Func>(func));
+        task->m_group = this;
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+        try {
+            m_pool.submit(task.get());
+        } catch (...) {
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+        task.release();
+    }
+
+    inline void TaskGroup::wait_for_tasks() noexcept {
+        Worker* self = m_pool.local_worker();
+        Backoff backoff;
+        while (m_pending.load(std::memory_order_acquire) > 0) {
+            if (Task* task = m_pool.find_task(self)) {
+                ThreadPool::run(task);
+                backoff.reset();
+            } else {
+                backoff();
+            }
+        }
+    }
+
+    inline void TaskGroup::wait() {
+        wait_for_tasks();
+        std::exception_ptr error;
+        {
+            std::lock_guard lock(m_error_mutex);
+            error = std::exchange(m_error, nullptr);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+namespace utility {
+    /**
+     * A fork/join thread pool. Each worker thread owns a
+     * WorkStealingDeque of tasks; tasks spawned by a worker go on its own
+     * deque, and idle workers steal from the others. Tasks are spawned and
+     * joined through a TaskGroup.
+     */
+    using detail::thread_pool::ThreadPool;
+
+    /**
+     * A set of tasks running on a ThreadPool. wait() runs pending tasks on
+     * the calling thread until every task in the group has finished, so
+     * tasks may themselves spawn and wait on nested task groups.
+     */
+    using detail::thread_pool::TaskGroup;
+}
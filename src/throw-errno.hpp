@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2020 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cerrno>
+#include <system_error>
+
+namespace utility {
+    /**
+     * Throws an std::system_error for the current value of `errno`, with
+     * `what` as its message.
+     */
+    [[noreturn]] inline void throw_errno(const char* what) {
+        namespace std = ::std;
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+}
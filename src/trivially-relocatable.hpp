@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <type_traits>
+
+namespace utility {
+    /**
+     * Whether objects of type `T` can be relocated (moved to a new address
+     * with the old object being destroyed) by copying their bytes with
+     * std::memcpy(). Defaults to std::is_trivially_copyable_v<T>;
+     * specialize this for types that are trivially relocatable but not
+     * trivially copyable (e.g., types that own a heap pointer but don't
+     * refer to their own address).
+     */
+    template <typename T>
+    struct is_trivially_relocatable : ::std::is_trivially_copyable<T> {
+    };
+
+    template <typename T>
+    inline constexpr bool is_trivially_relocatable_v = (
+        is_trivially_relocatable<T>::value
+    );
+}
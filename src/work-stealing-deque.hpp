@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2026 taylor.fish <contact@taylor.fish>
+ *
+ * This file is part of cxxutil.
+ *
+ * cxxutil is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cxxutil is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "cache-line.hpp"
+#include "pow2.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace utility::detail::work_stealing_deque {
+    namespace std = ::std;
+
+    using ::utility::cache_line_size;
+    using ::utility::pow2_ceil;
+
+    template <typename T>
+    class Buffer {
+        public:
+        explicit Buffer(std::size_t capacity) :
+        m_capacity(capacity),
+        m_items(std::make_unique<std::atomic<T>[]>(capacity)) {
+        }
+
+        std::size_t capacity() const noexcept {
+            return m_capacity;
+        }
+
+        T get(std::ptrdiff_t i) const noexcept {
+            return item(i).load(std::memory_order_relaxed);
+        }
+
+        void put(std::ptrdiff_t i, T value) noexcept {
+            item(i).store(value, std::memory_order_relaxed);
+        }
+
+        /**
+         * Creates a buffer with twice the capacity, containing the
+         * elements at indices [top, bottom).
+         */
+        std::unique_ptr<Buffer> grow(
+            std::ptrdiff_t top, std::ptrdiff_t bottom
+        ) const {
+            auto buffer = std::make_unique<Buffer>(m_capacity * 2);
+            for (std::ptrdiff_t i = top; i < bottom; ++i) {
+                buffer->put(i, get(i));
+            }
+            return buffer;
+        }
+
+        private:
+        std::atomic<T>& item(std::ptrdiff_t i) const noexcept {
+            auto index = static_cast<std::size_t>(i) & (m_capacity - 1);
+            return m_items[index];
+        }
+
+        std::size_t m_capacity = 0;
+        std::unique_ptr<std::atomic<T>[]> m_items;
+    };
+
+    template <typename T>
+    class WorkStealingDeque {
+        using Self = WorkStealingDeque;
+
+        static_assert(
+            std::is_trivially_copyable_v<T>,
+            "WorkStealingDeque requires trivially copyable types"
+        );
+
+        public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        explicit WorkStealingDeque(std::size_t capacity = 64) {
+            m_buffers.push_back(std::make_unique<Buffer<T>>(
+                pow2_ceil(std::max<std::size_t>(capacity, 2))
+            ));
+            m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const Self&) = delete;
+        Self& operator=(const Self&) = delete;
+
+        /**
+         * Gets the number of elements, which may be out of date by the
+         * time it is used.
+         */
+        std::size_t size_approx() const noexcept {
+            std::ptrdiff_t bottom = m_bottom.load(std::memory_order_relaxed);
+            std::ptrdiff_t top = m_top.load(std::memory_order_relaxed);
+            return static_cast<std::size_t>(
+                std::max<std::ptrdiff_t>(bottom - top, 0)
+            );
+        }
+
+        [[nodiscard]] bool empty_approx() const noexcept {
+            return size_approx() == 0;
+        }
+
+        /**
+         * Inserts an element at the bottom. Must be called only by the
+         * owner thread. If the buffer is full, it is replaced with one
+         * twice as large; old buffers are kept until the deque is
+         * destroyed, since thieves may still be reading them.
+         */
+        void push(T value) {
+            std::ptrdiff_t bottom = m_bottom.load(std::memory_order_relaxed);
+            std::ptrdiff_t top = m_top.load(std::memory_order_acquire);
+            Buffer<T>* buffer = m_buffer.load(std::memory_order_relaxed);
+            auto capacity = static_cast<std::ptrdiff_t>(buffer->capacity());
+            if (bottom - top >= capacity) {
+                m_buffers.push_back(buffer->grow(top, bottom));
+                buffer = m_buffers.back().get();
+                m_buffer.store(buffer, std::memory_order_release);
+            }
+            buffer->put(bottom, value);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Removes the element at the bottom, if there is one. Must be
+         * called only by the owner thread.
+         */
+        std::optional<T> pop() noexcept {
+            std::ptrdiff_t bottom = m_bottom.load(std::memory_order_relaxed);
+            Buffer<T>* buffer = m_buffer.load(std::memory_order_relaxed);
+            --bottom;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::ptrdiff_t top = m_top.load(std::memory_order_relaxed);
+
+            if (top > bottom) {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            T value = buffer->get(bottom);
+            if (top == bottom) {
+                // This is the last element; race against thieves for it.
+                bool won = m_top.compare_exchange_strong(
+                    top, top + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed
+                );
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                if (!won) {
+                    return std::nullopt;
+                }
+            }
+            return value;
+        }
+
+        /**
+         * Removes the element at the top, if there is one. May be called
+         * from any thread. Returns an empty optional if the deque is empty
+         * or another thread took the element first.
+         */
+        std::optional<T> steal() noexcept {
+            std::ptrdiff_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::ptrdiff_t bottom = m_bottom.load(std::memory_order_acquire);
+            if (top >= bottom) {
+                return std::nullopt;
+            }
+            Buffer<T>* buffer = m_buffer.load(std::memory_order_acquire);
+            T value = buffer->get(top);
+            if (!m_top.compare_exchange_strong(
+                top, top + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed
+            )) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        private:
+        alignas(cache_line_size) std::atomic<std::ptrdiff_t> m_top {0};
+        alignas(cache_line_size) std::atomic<std::ptrdiff_t> m_bottom {0};
+        std::atomic<Buffer<T>*> m_buffer {nullptr};
+
+        // Owned by the owner thread.
+        std::vector<std::unique_ptr<Buffer<T>>> m_buffers;
+    };
+}
+
+namespace utility {
+    /**
+     * template <typename T>
+     * class WorkStealingDeque;
+     *
+     * A lock-free Chase-Lev work-stealing deque of trivially copyable
+     * elements (usually pointers to tasks). The owner thread pushes and
+     * pops at the bottom; other threads steal from the top. Like
+     * ArrayDeque, the buffer is a power-of-2 ring with masked indices that
+     * grows by doubling.
+     */
+    using detail::work_stealing_deque::WorkStealingDeque;
+}
@@ -17,23 +17,1154 @@
  * along with cxxutil. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <vector>
+#include <unistd.h>
 
+#include <array-deque-io.hpp>
+#include <array-deque-stats.hpp>
 #include <array-deque.hpp>
+#include <backoff.hpp>
 #include <box.hpp>
+#include <cache-line.hpp>
+#include <chunked-deque.hpp>
 #include <first-type.hpp>
+#include <mirrored-ring-buffer.hpp>
+#include <mmap-allocator.hpp>
+#include <mpmc-queue.hpp>
+#include <parallel-algorithms.hpp>
+#include <persistent-deque.hpp>
 #include <pow2.hpp>
 #include <remove-cvref.hpp>
+#include <ring-buffer.hpp>
+#include <sliding-window.hpp>
 #include <smallest-uint.hpp>
+#include <spsc-queue.hpp>
+#include <span.hpp>
 #include <storage-for.hpp>
+#include <thread-pool.hpp>
+#include <throw-errno.hpp>
 #include <throw-or-terminate.hpp>
 #include <to-address.hpp>
+#include <trivially-relocatable.hpp>
 #include <variant.hpp>
+#include <work-stealing-deque.hpp>
 
+using utility::ArrayDeque;
 using utility::Variant;
 
+namespace {
+    struct Counted {
+        static inline int live = 0;
+        int value = 0;
+
+        Counted(int value = 0) : value(value) {
+            ++live;
+        }
+
+        Counted(const Counted& other) : value(other.value) {
+            ++live;
+        }
+
+        ~Counted() {
+            --live;
+        }
+
+        Counted& operator=(const Counted&) = default;
+    };
+
+    void test_array_deque_resize() {
+        ArrayDeque<int> ints;
+        for (int i = 0; i < 6; ++i) {
+            ints.push_back(i);
+        }
+        ints.pop_front();
+        ints.pop_front();
+        for (int i = 6; i < 40; ++i) {
+            ints.push_back(i);
+        }
+        assert(ints.size() == 38);
+        for (int i = 0; i < 38; ++i) {
+            assert(ints[i] == i + 2);
+        }
+
+        {
+            ArrayDeque<Counted> deque;
+            for (int i = 0; i < 20; ++i) {
+                deque.push_back(Counted(i));
+                deque.pop_front();
+                deque.push_back(Counted(i));
+            }
+            assert(Counted::live == 20);
+            deque.shrink_to_fit();
+            assert(Counted::live == 20);
+            assert(deque[19].value == 19);
+        }
+        assert(Counted::live == 0);
+    }
+
+    void test_array_deque_ranges() {
+        ArrayDeque<int> ints = {3, 4, 5};
+        int front[] = {0, 1, 2};
+        ints.prepend(std::begin(front), std::end(front));
+        ints.append({6, 7, 8, 9});
+        assert(ints.size() == 10);
+        for (int i = 0; i < 10; ++i) {
+            assert(ints[i] == i);
+        }
+
+        std::istringstream stream("-2 -1");
+        ints.prepend(
+            std::istream_iterator<int>(stream), std::istream_iterator<int>()
+        );
+        assert(ints.size() == 12);
+        assert(ints.front() == -2 && ints[1] == -1 && ints.back() == 9);
+
+        std::list<std::string> strings = {"a", "b", "c"};
+        ArrayDeque<std::string> deque(strings.begin(), strings.end());
+        deque.prepend({"x", "y"});
+        assert(deque.size() == 5 && deque[0] == "x" && deque[4] == "c");
+        deque.assign({"d"});
+        assert(deque.size() == 1 && deque.front() == "d");
+        deque.assign(strings.begin(), strings.end());
+        assert(deque.size() == 3 && deque[2] == "c");
+    }
+
+    void test_array_deque_spans() {
+        ArrayDeque<int> ints;
+        ints.reserve(8);
+        ints.append({0, 1, 2, 3, 4, 5});
+        ints.pop_front();
+        ints.pop_front();
+        ints.pop_front();
+        ints.append({6, 7, 8});
+
+        [[maybe_unused]] auto [first, second] = ints.as_spans();
+        assert(first.size() == 5 && second.size() == 1);
+        assert(first[0] == 3 && first[4] == 7 && second[0] == 8);
+
+        auto [free1, free2] = ints.free_spans();
+        assert(free1.size() + free2.size() == 2);
+        free1[0] = 9;
+        ints.commit_back(1);
+        assert(ints.back() == 9);
+
+        const ArrayDeque<int>& view = ints;
+        [[maybe_unused]] utility::span<const int> tail =
+            view.as_spans().second;
+        assert(tail.size() == 2 && tail[1] == 9);
+
+        // Wrapped with room to spare, then full.
+        utility::span<int> all = ints.make_contiguous();
+        assert(all.data() == &ints.front() && all.size() == 7);
+        assert(ints.as_spans().second.empty());
+        for (int i = 0; i < 7; ++i) {
+            assert(all[i] == i + 3);
+        }
+        ints.pop_front();
+        ints.append({10, 11});
+        assert(ints.capacity() == 8 && ints.as_spans().second.size() == 1);
+        all = ints.make_contiguous();
+        assert(all.size() == 8 && all[0] == 4 && all[7] == 11);
+        [[maybe_unused]] utility::span<int> again = ints.make_contiguous();
+        assert(again.data() == all.data());
+
+        ArrayDeque<std::string> strings = {"c", "d", "e"};
+        strings.reserve(8);
+        strings.prepend({"a", "b"});
+        [[maybe_unused]] auto letters = strings.make_contiguous();
+        assert(letters.size() == 5 && letters[0] == "a" && letters[4] == "e");
+        assert((strings == ArrayDeque<std::string>{"a", "b", "c", "d", "e"}));
+    }
+
+    void test_array_deque_algorithms() {
+        ArrayDeque<int> ints;
+        ints.reserve(8);
+        ints.append({0, 0, 0, 0, 0});
+        for (int i = 0; i < 5; ++i) {
+            ints.pop_front();
+        }
+        ints.append({1, 2, 3, 4, 5, 6});
+        assert(ints.as_spans().second.size() == 3);
+
+        int sorted[6];
+        std::copy(ints.begin(), ints.end(), sorted);
+        assert(std::is_sorted(ints.begin(), ints.end()));
+        assert(utility::accumulate(ints.begin(), ints.end(), 0) == 21);
+        assert(utility::find(ints.begin(), ints.end(), 5) - ints.begin() == 4);
+        assert(utility::find(ints.begin(), ints.end(), 7) == ints.end());
+        assert(*std::lower_bound(ints.begin(), ints.end(), 3) == 3);
+        [[maybe_unused]] auto wrapped = ints.begin() + 4;
+        assert(wrapped > ints.begin() + 2 && ints.end() - wrapped == 2);
+        std::sort(ints.begin(), ints.end(), std::greater<int>());
+        assert(ints.front() == 6 && ints.back() == 1);
+        std::sort(ints.begin(), ints.end());
+        static_assert(
+            sizeof(ArrayDeque<int>::iterator) == sizeof(void*) * 3,
+            "iterators should be three words"
+        );
+
+        ArrayDeque<int> other(std::begin(sorted), std::end(sorted));
+        assert(other == ints);
+        utility::fill(other.end() - 2, other.end(), 0);
+        assert(other < ints && !(ints < other));
+        utility::copy(ints.begin() + 4, ints.end(), other.begin() + 4);
+        assert(other == ints);
+        utility::copy(std::begin(sorted), std::end(sorted), ints.begin());
+        assert(other == ints);
+        other.pop_back();
+        assert(other < ints && other != ints);
+    }
+
+    /**
+     * Inserts three elements near the front of a deque whose head is at
+     * various offsets, so that the elements before the insertion point
+     * are relocated across the start of the buffer when head < 3.
+     */
+    template <typename Deque>
+    void check_front_inserts() {
+        for (std::size_t head = 0; head < 4; ++head) {
+            for (std::size_t i = 0; i < 3; ++i) {
+                Deque deque;
+                deque.reserve(12);
+                for (std::size_t j = 0; j < head; ++j) {
+                    deque.push_back(-1);
+                }
+                deque.append({0, 1, 2, 3, 4, 5, 6});
+                for (std::size_t j = 0; j < head; ++j) {
+                    deque.pop_front();
+                }
+                std::vector<int> expected(deque.begin(), deque.end());
+                deque.insert(deque.begin() + i, {7, 8, 9});
+                expected.insert(expected.begin() + i, {7, 8, 9});
+                assert(std::equal(
+                    deque.begin(), deque.end(),
+                    expected.begin(), expected.end()
+                ));
+            }
+        }
+    }
+
+    void test_array_deque_insert_erase() {
+        ArrayDeque<int> ints;
+        ints.reserve(16);
+        ints.append({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+        ints.erase(ints.begin(), ints.begin() + 10);
+        ints.erase(ints.begin(), ints.end());
+        ints.append({0, 1, 2, 6, 7, 8, 9, 10, 11});
+        [[maybe_unused]] auto it = ints.insert(ints.begin() + 3, {3, 4, 5});
+        assert(*it == 3 && ints.size() == 12 && ints.capacity() == 16);
+        ints.insert(ints.end() - 1, {-1, -2});
+        ints.erase(ints.end() - 3, ints.end() - 1);
+        for (int i = 0; i < 12; ++i) {
+            assert(ints[i] == i);
+        }
+        it = ints.erase(ints.begin() + 1);
+        assert(*it == 2);
+        it = ints.erase(ints.begin() + 8, ints.begin() + 10);
+        assert(*it == 11);
+        ints.emplace(ints.begin() + 1, 1);
+        ints.insert(ints.begin() + 9, {9, 10});
+        for (int i = 0; i < 12; ++i) {
+            assert(ints[i] == i);
+        }
+
+        // Opening a gap at the front with head < n wraps below index 0.
+        ArrayDeque<int> wrap = {0, 1, 2, 3, 4, 5, 6};
+        wrap.reserve(16);
+        wrap.insert(wrap.begin() + 1, 9);
+        assert((wrap == ArrayDeque<int>{0, 9, 1, 2, 3, 4, 5, 6}));
+        check_front_inserts<ArrayDeque<int>>();
+        check_front_inserts<ArrayDeque<
+            int, std::allocator<int>, 0, utility::ExactCapacity<>
+        >>();
+
+        ArrayDeque<std::string> strings = {"a", "d", "e"};
+        strings.insert(strings.begin() + 1, {"b", "c"});
+        strings.insert(strings.end() - 1, std::string("x"));
+        assert(strings.size() == 6 && strings[1] == "b" && strings[4] == "x");
+        strings.erase(strings.begin() + 4);
+        strings.erase(strings.begin() + 1, strings.begin() + 2);
+        assert((strings == ArrayDeque<std::string>{"a", "c", "d", "e"}));
+
+        {
+            ArrayDeque<Counted> counted;
+            for (int i = 0; i < 10; ++i) {
+                counted.emplace_back(i);
+            }
+            counted.erase(counted.begin() + 2, counted.begin() + 5);
+            counted.insert(counted.begin() + 5, Counted(42));
+            assert(Counted::live == 8 && counted[5].value == 42);
+            assert(counted[2].value == 5 && counted[7].value == 9);
+        }
+        assert(Counted::live == 0);
+    }
+
+    void test_array_deque_drain() {
+        ArrayDeque<int> ints;
+        ints.reserve(8);
+        ints.append({0, 0, 0, 0, 0, 0});
+        ints.pop_front_n(5);
+        ints.append({1, 2, 3, 4, 5, 6, 7});
+        assert(ints.as_spans().second.size() == 5);
+
+        int out[8] = {};
+        [[maybe_unused]] std::size_t drained_n = ints.drain_front(out, 5);
+        assert(drained_n == 5);
+        assert(ints.size() == 3 && ints.front() == 5);
+        drained_n = ints.drain_front(out + 5, 8);
+        assert(drained_n == 3 && ints.empty());
+        for (int i = 0; i < 8; ++i) {
+            assert(out[i] == i);
+        }
+        drained_n = ints.drain_front(out, 1);
+        assert(drained_n == 0);
+
+        ints.append({1, 2, 3, 4});
+        ints.pop_back_n(3);
+        assert(ints.size() == 1 && ints.back() == 1);
+
+        ArrayDeque<std::string> strings = {"c", "d"};
+        strings.prepend({"a", "b"});
+        std::vector<std::string> drained;
+        strings.drain_front(std::back_inserter(drained), 3);
+        assert(drained.size() == 3 && drained[0] == "a" && drained[2] == "c");
+        assert(strings.size() == 1 && strings.front() == "d");
+
+        {
+            ArrayDeque<Counted> counted;
+            for (int i = 0; i < 10; ++i) {
+                counted.emplace_front(i);
+            }
+            counted.pop_front_n(4);
+            counted.pop_back_n(3);
+            assert(Counted::live == 3 && counted.front().value == 5);
+        }
+        assert(Counted::live == 0);
+    }
+
+    void test_array_deque_resize_elements() {
+        ArrayDeque<int> ints = {-1, 1, 2};
+        ints.pop_front();
+        ints.resize(6);
+        assert(ints.size() == 6 && ints.capacity() == 8);
+        assert(ints[0] == 1 && ints[1] == 2 && ints[5] == 0);
+        ints.resize(10, 7);
+        assert(ints.size() == 10 && ints[6] == 7 && ints[9] == 7);
+        ints.resize(2);
+        assert((ints == ArrayDeque<int>{1, 2}));
+
+        ints.resize_default_init(5);
+        auto [first, second] = ints.as_spans();
+        std::fill(first.begin() + 2, first.end(), 3);
+        std::fill(second.begin(), second.end(), 3);
+        assert(ints.size() == 5 && ints[1] == 2 && ints[4] == 3);
+
+        ArrayDeque<std::string> strings = {"a"};
+        strings.resize(3, "b");
+        strings.resize_default_init(4);
+        assert(strings[2] == "b" && strings[3].empty());
+        {
+            ArrayDeque<Counted> counted;
+            counted.resize(5);
+            counted.push_front(Counted(1));
+            counted.resize(3);
+            assert(Counted::live == 3 && counted[0].value == 1);
+        }
+        assert(Counted::live == 0);
+    }
+
+    void test_array_deque_trivial_copy() {
+        ArrayDeque<int> ints;
+        ints.reserve(16);
+        ints.append({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+        ints.pop_front_n(12);
+        for (int i = 0; i < 10; ++i) {
+            ints.push_back(i);
+        }
+        assert(!ints.as_spans().second.empty());
+
+        ArrayDeque<int> copy(ints);
+        assert(copy == ints && copy.capacity() == 16);
+        assert(copy.as_spans().second.empty());
+
+        ArrayDeque<int> small = {1, 2};
+        small = ints;
+        assert(small == ints && small.capacity() == 16);
+        ArrayDeque<int> large;
+        large.reserve(64);
+        large.append({5, 6, 7});
+        large = copy;
+        assert(large == ints && large.capacity() == 64);
+        large = static_cast<const ArrayDeque<int>&>(large);
+        assert(large == ints);
+        large = ArrayDeque<int>{1};
+        assert(large.size() == 1 && large.front() == 1);
+        large.clear();
+        assert(large.empty() && large.capacity() == 0);
+    }
+
+    void test_array_deque_stats() {
+        #if CXXUTIL_ARRAY_DEQUE_STATS
+            // Counters are registered on first use, inside noexcept code.
+            static_assert(std::is_nothrow_default_constructible_v<
+                utility::detail::array_deque_stats::ThreadStats
+            >);
+            static int resize_events = 0;
+            [[maybe_unused]] static std::size_t last_capacity = 0;
+            utility::set_array_deque_resize_hook(
+                [](const utility::ResizeEvent& event) {
+                    ++resize_events;
+                    last_capacity = event.new_capacity;
+                }
+            );
+
+            ArrayDeque<int> ints;
+            for (int i = 0; i < 5; ++i) {
+                ints.push_back(i);
+            }
+            ints.pop_back_n(3);
+            ints.shrink_to_fit();
+            [[maybe_unused]] const utility::ArrayDequeStats& stats =
+                ints.stats();
+            assert(stats.grows == 3 && stats.resizes == 4);
+            assert(stats.allocations == 5 && stats.peak_capacity == 8);
+            assert(stats.bytes_allocated == (1 + 2 + 4 + 8 + 2) * sizeof(int));
+            assert(stats.bytes_moved == (1 + 2 + 4 + 2) * sizeof(int));
+            assert(resize_events == 4 && last_capacity == 2);
+            utility::set_array_deque_resize_hook(nullptr);
+
+            [[maybe_unused]] auto before =
+                utility::array_deque_global_stats();
+            std::thread thread([] {
+                ArrayDeque<long> longs;
+                longs.reserve(1000);
+            });
+            thread.join();
+            [[maybe_unused]] auto after = utility::array_deque_global_stats();
+            assert(after.allocations == before.allocations + 1);
+            assert(after.peak_capacity >= 1024 && resize_events == 4);
+
+            // Growth through MmapAllocator::reallocate() is counted as an
+            // allocation too.
+            using MmapDeque = ArrayDeque<int, utility::MmapAllocator<int>>;
+            MmapDeque mapped;
+            for (int i = 0; i < 10; ++i) {
+                mapped.push_back(i);
+            }
+            assert(mapped.stats().grows == 4 && mapped.stats().resizes == 4);
+            assert(mapped.stats().allocations == 5);
+            assert(mapped.stats().peak_capacity == 16);
+            assert(
+                mapped.stats().bytes_allocated ==
+                (1 + 2 + 4 + 8 + 16) * sizeof(int)
+            );
+
+            // Statistics move and swap with the contents.
+            MmapDeque moved(std::move(mapped));
+            assert(moved.stats().allocations == 5);
+            assert(mapped.stats().allocations == 0);
+            mapped.push_back(0);
+            swap(mapped, moved);
+            assert(mapped.stats().allocations == 5);
+            assert(moved.stats().allocations == 1);
+        #endif
+    }
+
+    void test_array_deque_exact_capacity() {
+        using utility::ExactCapacity;
+        using Deque = ArrayDeque<int, std::allocator<int>, 0, ExactCapacity<>>;
+
+        Deque ints;
+        ints.reserve(33);
+        assert(ints.capacity() == 33);
+        for (int i = 0; i < 33; ++i) {
+            ints.push_back(i);
+        }
+        ints.push_back(33);
+        assert(ints.capacity() == 49);
+        for (int i = 0; i < 20; ++i) {
+            ints.pop_front();
+            ints.push_back(34 + i);
+        }
+        for (int i = 19; i >= 0; --i) {
+            ints.push_front(i);
+        }
+        [[maybe_unused]] auto [head, tail] = ints.as_spans();
+        assert(!tail.empty() && head.size() + tail.size() == 54);
+        for (int i = 0; i < 54; ++i) {
+            assert(ints[i] == i);
+        }
+        assert(utility::accumulate(ints.begin(), ints.end(), 0) == 1431);
+
+        ints.erase(ints.begin() + 10, ints.begin() + 20);
+        ints.insert(ints.begin() + 10, 10);
+        ints.shrink_to_fit();
+        assert(ints.capacity() == 45 && ints[10] == 10 && ints[11] == 20);
+        ints.prepend({-3, -2, -1});
+        assert(ints.front() == -3 && ints.back() == 53);
+
+        Deque small = {1, 2, 3};
+        assert(small.capacity() == 3);
+        small.push_front(0);
+        assert(small.capacity() == 4 && small.front() == 0);
+    }
+
+    void test_array_deque_auto_shrink() {
+        using utility::AutoShrink;
+        using Deque = ArrayDeque<int, std::allocator<int>, 0, AutoShrink<>>;
+
+        Deque ints;
+        for (int i = 0; i < 64; ++i) {
+            ints.push_back(i);
+        }
+        assert(ints.capacity() == 64);
+        ints.pop_front_n(48);
+        assert(ints.capacity() == 64);
+        ints.pop_front();
+        assert(ints.capacity() == 32 && ints.front() == 49);
+        for (int i = 0; i < 12; ++i) {
+            ints.pop_back();
+        }
+        assert(ints.capacity() == 8 && ints.size() == 3);
+        assert(ints.front() == 49 && ints.back() == 51);
+        ints.push_back(52);
+        ints.pop_back();
+        assert(ints.capacity() == 8);
+
+        // Bulk removals shrink all the way at once, through every path.
+        Deque big;
+        big.resize(1000);
+        big.pop_back_n(999);
+        assert(big.capacity() == 2 && big.size() == 1);
+        big.resize(64);
+        big.erase(big.begin(), big.begin() + 60);
+        assert(big.capacity() == 8 && big.size() == 4);
+        big.resize(64);
+        int out[62];
+        big.drain_front(out, 62);
+        assert(big.capacity() == 4 && big.size() == 2);
+
+        ints.clear_keep_capacity();
+        assert(ints.empty() && ints.capacity() == 8);
+        ints.push_front(1);
+        assert(ints.front() == 1 && ints.capacity() == 8);
+
+        ArrayDeque<int> fixed = {1, 2, 3, 4};
+        fixed.pop_front_n(4);
+        assert(fixed.capacity() == 4);
+    }
+
+    void test_mmap_allocator() {
+        using utility::MmapAllocator;
+        using Deque = ArrayDeque<int, MmapAllocator<int>>;
+
+        // Small buffers use realloc(); large ones use mremap(). In both
+        // cases the elements wrap around the end before growing.
+        for (int n : {16, 1 << 19}) {
+            Deque ints;
+            ints.reserve(n);
+            for (int i = 0; i < n; ++i) {
+                ints.push_back(i);
+            }
+            for (int i = 0; i < n / 4; ++i) {
+                ints.pop_front();
+                ints.push_back(n + i);
+            }
+            ints.push_back(n + n / 4);
+            assert(ints.capacity() == std::size_t(n) * 2);
+            for (int i = 0; i < n / 4; ++i) {
+                ints.push_front(n / 4 - 1 - i);
+            }
+            for (int i = 0; i <= n + n / 4; ++i) {
+                assert(ints[i] == i);
+            }
+        }
+
+        Deque wrapped;
+        wrapped.reserve(1 << 19);
+        wrapped.append({1, 2, 3});
+        wrapped.prepend({-1, 0});
+        wrapped.reserve(1 << 20);
+        assert((wrapped == Deque{-1, 0, 1, 2, 3}));
+    }
+
+    void test_array_deque_io() {
+        struct Record {
+            int id;
+            char tag;
+        };
+        ArrayDeque<Record> records;
+        records.reserve(8);
+        for (int i = 0; i < 8; ++i) {
+            records.push_back({i, 'a'});
+        }
+        records.pop_front_n(5);
+        for (int i = 8; i < 12; ++i) {
+            records.push_back({i, 'b'});
+        }
+        [[maybe_unused]] auto iov = utility::as_iovecs(records);
+        assert(iov[0].iov_len + iov[1].iov_len == sizeof(Record) * 7);
+        assert(iov[1].iov_len == sizeof(Record) * 4);
+
+        int fds[2];
+        [[maybe_unused]] int result = ::pipe(fds);
+        assert(result == 0);
+        utility::write_to(fds[1], records);
+        utility::write_to(fds[1], ArrayDeque<Record>());
+        ::close(fds[1]);
+
+        ArrayDeque<Record> copy = {{-1, 'x'}};
+        utility::read_from(fds[0], copy);
+        assert(copy.size() == 7 && copy.capacity() == 8);
+        for (int i = 0; i < 7; ++i) {
+            assert(copy[i].id == i + 5 && copy[i].tag == "aaabbbb"[i]);
+        }
+        utility::read_from(fds[0], copy);
+        assert(copy.empty());
+        [[maybe_unused]] bool threw = false;
+        try {
+            utility::read_from(fds[0], copy);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        ::close(fds[0]);
+    }
+
+    void test_mirrored_ring_buffer() {
+        utility::MirroredRingBuffer<char> chars(100);
+        std::size_t capacity = chars.capacity();
+        assert(capacity >= 100 && capacity % 4096 == 0);
+        std::string filler(capacity - 3, 'x');
+        chars.append(filler.data(), filler.size());
+        chars.pop_front_n(filler.size());
+        chars.append("hello, world", 12);
+        assert(std::string(chars.data(), chars.size()) == "hello, world");
+        assert(chars.free_span().size() == capacity - 12);
+        chars.pop_front_n(7);
+        chars.push_front(' ');
+        chars.push_back('!');
+        [[maybe_unused]] auto view = chars.as_span();
+        assert(std::string(view.begin(), view.end()) == " world!");
+
+        struct Triple {
+            int a, b, c;
+        };
+        utility::MirroredRingBuffer<Triple> triples(1);
+        assert(triples.capacity() * sizeof(Triple) % 4096 == 0);
+        for (std::size_t i = 0; i < triples.capacity() * 3 / 2; ++i) {
+            if (triples.full()) {
+                triples.pop_front();
+            }
+            triples.push_back({int(i), 0, 0});
+        }
+        assert(triples.full() && triples.back().c == 0);
+        for (std::size_t i = 1; i < triples.size(); ++i) {
+            assert(triples.data()[i].a == triples.data()[i - 1].a + 1);
+        }
+    }
+
+    void test_persistent_deque() {
+        using utility::PersistentDeque;
+        struct Record {
+            int id;
+            double value;
+        };
+
+        char path[] = "/tmp/cxxutil-test-XXXXXX";
+        int fd = ::mkstemp(path);
+        assert(fd >= 0);
+        ::close(fd);
+        {
+            PersistentDeque<Record> records(path);
+            assert(records.empty() && records.capacity() == 0);
+            for (int i = 0; i < 8; ++i) {
+                records.push_back({i, i * 0.5});
+            }
+            for (int i = 8; i < 14; ++i) {
+                records.pop_front();
+                records.push_back({i, i * 0.5});
+            }
+            assert(records.size() == 8 && records.capacity() == 8);
+            assert(records.as_spans().second.size() == 6);
+            records.flush();
+        }
+        {
+            PersistentDeque<Record> records(path);
+            assert(records.size() == 8 && records.capacity() == 8);
+            for (int i = 0; i < 8; ++i) {
+                assert(records[i].id == i + 6);
+                assert(records[i].value == (i + 6) * 0.5);
+            }
+            records.push_back({14, 7});
+            records.push_front({5, 2.5});
+            assert(records.capacity() == 16 && records.size() == 10);
+            for (int i = 0; i < 10; ++i) {
+                assert(records.at(i).id == i + 5);
+            }
+            records.clear();
+        }
+        {
+            PersistentDeque<Record> records(path);
+            assert(records.empty() && records.capacity() == 16);
+        }
+        [[maybe_unused]] bool threw = false;
+        try {
+            PersistentDeque<int> ints(path);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        ::unlink(path);
+    }
+
+    void test_small_array_deque() {
+        using utility::SmallArrayDeque;
+        SmallArrayDeque<std::string, 4> small;
+        assert(small.capacity() == 4);
+        small.append({"a", "b", "c"});
+        small.pop_front();
+        small.append({"d", "e"});
+        assert(small.capacity() == 4 && small.as_spans().second.size() == 1);
+
+        SmallArrayDeque<std::string, 4> moved(std::move(small));
+        assert(small.empty() && small.capacity() == 4);
+        assert(moved.size() == 4 && moved[0] == "b" && moved[3] == "e");
+
+        small.push_back("x");
+        moved.push_back("f");
+        assert(moved.capacity() == 8);
+        swap(small, moved);
+        assert(small.size() == 5 && small.back() == "f");
+        assert(moved.size() == 1 && moved.front() == "x");
+
+        small.pop_front();
+        small.shrink_to_fit();
+        assert(small.capacity() == 4 && small.front() == "c");
+        SmallArrayDeque<std::string, 4> copy = small;
+        assert(copy == small);
+        copy.clear();
+        assert(copy.capacity() == 4);
+        copy = std::move(small);
+        assert(copy.size() == 4 && copy.back() == "f");
+
+        {
+            SmallArrayDeque<Counted, 2> counted;
+            for (int i = 0; i < 5; ++i) {
+                counted.push_back(Counted(i));
+            }
+            SmallArrayDeque<Counted, 2> other;
+            other.push_back(Counted(9));
+            counted.swap(other);
+            assert(Counted::live == 6);
+        }
+        assert(Counted::live == 0);
+    }
+
+    void test_chunked_deque() {
+        using utility::ChunkedDeque;
+        static_assert(utility::detail::chunked_deque::default_block_size<
+            std::array<char, 4096>
+        > == 16);
+
+        ChunkedDeque<int, std::allocator<int>, 4> ints;
+        ints.push_back(0);
+        [[maybe_unused]] int* first = &ints.front();
+        for (int i = 1; i < 20; ++i) {
+            ints.push_back(i);
+            ints.push_front(-i);
+        }
+        assert(ints.size() == 39 && &ints[19] == first);
+        assert(ints.front() == -19 && ints.back() == 19);
+        assert(std::is_sorted(ints.begin(), ints.end()));
+        assert(ints.end() - ints.begin() == 39 && ints.begin()[20] == 1);
+        for (int i = 0; i < 19; ++i) {
+            ints.pop_front();
+            ints.pop_back();
+        }
+        assert(ints.size() == 1 && &ints.front() == first);
+        [[maybe_unused]] bool threw = false;
+        try {
+            ints.at(1);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+
+        ChunkedDeque<std::string, std::allocator<std::string>, 2> strs = {
+            "a", "b", "c",
+        };
+        ChunkedDeque<std::string, std::allocator<std::string>, 2> copy;
+        copy = strs;
+        copy.emplace_front(3, 'z');
+        assert(copy.size() == 4 && copy[0] == "zzz" && copy[3] == "c");
+        strs = std::move(copy);
+        assert(strs.size() == 4 && copy.empty());
+        [[maybe_unused]] ChunkedDeque<
+            std::string, std::allocator<std::string>, 2
+        >::const_iterator it = strs.begin() + 1;
+        assert(*it == "a");
+
+        {
+            ChunkedDeque<Counted, std::allocator<Counted>, 2> counted;
+            for (int i = 0; i < 7; ++i) {
+                counted.emplace_back(i);
+            }
+            counted.pop_front();
+            assert(Counted::live == 6);
+            auto other = counted;
+            assert(Counted::live == 12 && other.back().value == 6);
+            other.clear();
+            assert(Counted::live == 6);
+        }
+        assert(Counted::live == 0);
+    }
+
+    void test_ring_buffer() {
+        utility::RingBuffer<int> ints(3);
+        assert(ints.capacity() == 4 && ints.empty());
+        for (int i = 0; i < 10; ++i) {
+            ints.push_back_overwrite(i);
+        }
+        assert(ints.full() && ints.front() == 6 && ints.back() == 9);
+        assert(utility::accumulate(ints.begin(), ints.end(), 0) == 30);
+        ints.pop_front();
+        ints.push_back(10);
+        assert(ints.front() == 7 && ints.capacity() == 4);
+        ints.clear();
+        assert(ints.empty() && ints.capacity() == 4);
+
+        {
+            utility::RingBuffer<Counted> counted(2);
+            for (int i = 0; i < 5; ++i) {
+                counted.push_back_overwrite(Counted(i));
+            }
+            assert(Counted::live == 2 && counted.front().value == 3);
+        }
+        assert(Counted::live == 0);
+    }
+
+    void test_sliding_window() {
+        using utility::SlidingWindow;
+        std::vector<int> values;
+        unsigned seed = 1;
+        for (int i = 0; i < 200; ++i) {
+            seed = seed * 1103515245 + 12345;
+            values.push_back(static_cast<int>(seed >> 16) % 100);
+        }
+
+        SlidingWindow<int, utility::WindowMin<>> min(5);
+        SlidingWindow<int, utility::WindowMax<>> max(5);
+        SlidingWindow<int, std::plus<>> sum(5);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            min.push(values[i]);
+            max.push(values[i]);
+            sum.push(values[i]);
+            [[maybe_unused]] auto first = values.begin() + (i < 4 ? 0 : i - 4);
+            [[maybe_unused]] auto last = values.begin() + i + 1;
+            assert(min.size() == static_cast<std::size_t>(last - first));
+            assert(min.value() == *std::min_element(first, last));
+            assert(max.value() == *std::max_element(first, last));
+            assert(sum.value() == std::accumulate(first, last, 0));
+        }
+
+        // Non-commutative operations are applied in window order.
+        SlidingWindow<std::string, std::plus<>> cat(3);
+        std::vector<std::string> words = {"a", "b", "c", "d", "e"};
+        cat.push_n(words.begin(), 2);
+        assert(cat.value() == "ab");
+        cat.push_n(words.begin() + 2, 2);
+        assert(cat.size() == 3 && cat.value() == "bcd");
+        cat.pop_front();
+        cat.push("x");
+        assert(cat.value() == "cdx" && cat.front() == "c");
+        cat.push_n(words.begin(), words.size());
+        assert(cat.value() == "cde" && cat.full());
+        cat.clear();
+        assert(cat.empty());
+
+        // An operation that throws while the front stack is rebuilt leaves
+        // the window unchanged.
+        struct FailingPlus {
+            int* calls_left;
+
+            int operator()(int a, int b) const {
+                if (*calls_left == 0) {
+                    throw std::runtime_error("operation failed");
+                }
+                --*calls_left;
+                return a + b;
+            }
+        };
+        int calls_left = 100;
+        SlidingWindow<int, FailingPlus> failing(4, FailingPlus{&calls_left});
+        failing.push_n(values.begin(), 4);
+        calls_left = 1;
+        [[maybe_unused]] bool threw = false;
+        try {
+            failing.pop_front();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        calls_left = 100;
+        assert(threw && failing.size() == 4);
+        assert(failing.value() == std::accumulate(
+            values.begin(), values.begin() + 4, 0
+        ));
+        failing.pop_front();
+        assert(failing.value() == std::accumulate(
+            values.begin() + 1, values.begin() + 4, 0
+        ));
+
+        // Window size 0: elements are removed only by pop_front().
+        SlidingWindow<int, utility::WindowMax<std::greater<>>> unbounded;
+        unbounded.push_n(values.begin(), values.size());
+        assert(unbounded.size() == values.size());
+        unbounded.pop_front();
+        assert(unbounded.value() == *std::min_element(
+            values.begin() + 1, values.end()
+        ));
+    }
+
+    void test_spsc_queue() {
+        constexpr int count = 100000;
+        utility::SpscQueue<int> queue(100);
+        assert(queue.capacity() == 128);
+
+        std::thread producer([&] {
+            int batch[7];
+            for (int i = 0; i < count;) {
+                int n = std::min(7, count - i);
+                for (int j = 0; j < n; ++j) {
+                    batch[j] = i + j;
+                }
+                int* it = batch;
+                for (utility::Backoff backoff; n > 0; backoff()) {
+                    std::size_t pushed = queue.try_push_n(it, n);
+                    it += pushed;
+                    n -= static_cast<int>(pushed);
+                    i += static_cast<int>(pushed);
+                }
+            }
+        });
+
+        int batch[5];
+        utility::Backoff backoff;
+        for (int expected = 0; expected < count; backoff()) {
+            std::size_t n = queue.try_pop_n(batch, 5);
+            for (std::size_t i = 0; i < n; ++i, ++expected) {
+                assert(batch[i] == expected);
+            }
+        }
+        producer.join();
+        assert(queue.empty_approx());
+
+        {
+            utility::SpscQueue<std::string> strings(4);
+            std::string items[] = {"a", "b", "c", "d", "e"};
+            [[maybe_unused]] std::size_t pushed = strings.try_push_n(
+                std::begin(items), 5
+            );
+            assert(pushed == 4);
+            [[maybe_unused]] bool pushed_full = strings.try_push("f");
+            assert(!pushed_full);
+            std::string out;
+            [[maybe_unused]] bool popped = strings.try_pop(out);
+            assert(popped && out == "a");
+            assert(*strings.front() == "b");
+            strings.pop();
+        }
+    }
+
+    void test_mpmc_queue() {
+        constexpr int threads = 4;
+        constexpr int per_thread = 20000;
+        utility::MpmcQueue<long> queue(64);
+        std::atomic<long> sum {0};
+        std::vector<std::thread> workers;
+
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                long batch[8];
+                for (int i = 0; i < per_thread; i += 8) {
+                    for (int j = 0; j < 8; ++j) {
+                        batch[j] = t * per_thread + i + j;
+                    }
+                    queue.push_n(batch, 8);
+                }
+            });
+            workers.emplace_back([&] {
+                long batch[4];
+                long local = 0;
+                for (int i = 0; i < per_thread; i += 4) {
+                    queue.pop_n(batch, 4);
+                    local += batch[0] + batch[1] + batch[2] + batch[3];
+                }
+                sum += local;
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        [[maybe_unused]] long n = threads * per_thread;
+        assert(sum == n * (n - 1) / 2);
+        assert(queue.size_approx() == 0);
+
+        utility::MpmcQueue<std::string> strings(2);
+        [[maybe_unused]] bool pushed = strings.try_push("a");
+        pushed = pushed && strings.try_emplace(1, 'b');
+        assert(pushed);
+        pushed = strings.try_push("c");
+        assert(!pushed);
+        std::string out;
+        [[maybe_unused]] bool popped = strings.try_pop(out);
+        assert(popped && out == "a");
+        strings.push("c");
+        out = strings.pop();
+        assert(out == "b");
+    }
+
+    long fib(utility::ThreadPool& pool, int n) {
+        if (n < 12) {
+            return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+        }
+        long a = 0;
+        long b = 0;
+        utility::TaskGroup group(pool);
+        group.run([&] {
+            a = fib(pool, n - 1);
+        });
+        b = fib(pool, n - 2);
+        group.wait();
+        return a + b;
+    }
+
+    void test_thread_pool() {
+        utility::WorkStealingDeque<int> deque(2);
+        for (int i = 0; i < 5; ++i) {
+            deque.push(i);
+        }
+        [[maybe_unused]] auto stolen = deque.steal();
+        [[maybe_unused]] auto popped = deque.pop();
+        assert(stolen == 0 && popped == 4);
+        assert(deque.size_approx() == 3);
+
+        utility::ThreadPool pool(4);
+        assert(fib(pool, 24) == 46368);
+
+        std::atomic<int> count {0};
+        utility::TaskGroup group(pool);
+        for (int i = 0; i < 1000; ++i) {
+            group.run([&] {
+                ++count;
+            });
+        }
+        group.run([] {
+            throw std::runtime_error("task failed");
+        });
+        [[maybe_unused]] bool caught = false;
+        try {
+            group.wait();
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        assert(caught && count == 1000);
+    }
+
+    void test_parallel_algorithms() {
+        utility::ThreadPool pool(4);
+        {
+            // Large ranges get more chunks, not larger ones.
+            namespace pa = utility::detail::parallel_algorithms;
+            [[maybe_unused]] std::size_t size;
+            size = pa::chunk_size<int>(pool, 50'000'000);
+            assert(size * sizeof(int) == pa::max_chunk_bytes);
+            size = pa::chunk_size<int>(pool, 1 << 15);
+            assert(size * sizeof(int) == pa::min_chunk_bytes);
+        }
+        ArrayDeque<long> longs;
+        longs.reserve(1 << 17);
+        longs.resize(1 << 16);
+        longs.pop_front_n(1 << 16);
+        const long n = 100000;
+        for (long i = 0; i < n; ++i) {
+            longs.push_back((i * 7919) % n);
+        }
+        assert(!longs.as_spans().second.empty());
+
+        utility::for_each(pool, longs.begin(), longs.end(), [](long& x) {
+            x *= 2;
+        });
+        [[maybe_unused]] long sum = utility::reduce(
+            pool, longs.begin(), longs.end(), 0L
+        );
+        assert(sum == n * (n - 1));
+
+        std::vector<long> halves(n);
+        utility::transform(
+            pool, longs.begin(), longs.end(), halves.begin(), [](long x) {
+                return x / 2;
+            }
+        );
+        assert(halves[1] == 7919);
+
+        utility::sort(pool, longs.begin(), longs.end());
+        for (long i = 0; i < n; ++i) {
+            assert(longs[i] == i * 2);
+        }
+        utility::sort(pool, longs.begin(), longs.end(), std::greater<>());
+        assert(longs.front() == (n - 1) * 2 && longs.back() == 0);
+
+        ArrayDeque<long> copy;
+        copy.resize(n);
+        utility::copy(pool, longs.cbegin(), longs.cend(), copy.begin());
+        assert(copy == longs);
+
+        ArrayDeque<int> small = {3, 1, 2};
+        utility::sort(pool, small.begin(), small.end());
+        assert((small == ArrayDeque<int>{1, 2, 3}));
+        assert(utility::reduce(pool, small.begin(), small.end(), 10) == 16);
+    }
+}
+
 int main() {
+    test_array_deque_resize();
+    test_array_deque_ranges();
+    test_array_deque_spans();
+    test_array_deque_algorithms();
+    test_array_deque_insert_erase();
+    test_array_deque_drain();
+    test_array_deque_resize_elements();
+    test_array_deque_trivial_copy();
+    test_array_deque_stats();
+    test_array_deque_exact_capacity();
+    test_array_deque_auto_shrink();
+    test_mmap_allocator();
+    test_array_deque_io();
+    test_mirrored_ring_buffer();
+    test_persistent_deque();
+    test_small_array_deque();
+    test_chunked_deque();
+    test_ring_buffer();
+    test_sliding_window();
+    test_spsc_queue();
+    test_mpmc_queue();
+    test_thread_pool();
+    test_parallel_algorithms();
+
     Variant<int, int*> v(5);
     assert(v.get<int>() == 5);
     v = nullptr;